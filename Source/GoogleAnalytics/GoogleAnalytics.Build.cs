@@ -18,7 +18,7 @@ namespace UnrealBuildTool.Rules
 			PrivateDependencyModuleNames.AddRange(new string[] { "Analytics", "HTTP", "Json" });
 			PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine" });
 			PrivateIncludePathModuleNames.AddRange(new string[] { "Settings" });
-			PublicIncludePathModuleNames.Add("Analytics");
+			PublicIncludePathModuleNames.AddRange(new string[] { "Analytics", "HTTP" });
 
 			string ThirdPartyPath = Path.Combine(ModuleDirectory, "..", "ThirdParty");
 			string ThirdPartyIOSPath = Path.Combine(ThirdPartyPath, "IOS");
@@ -14,6 +14,8 @@
 #include <string>
 #include "ISettingsModule.h"
 #include "GoogleAnalyticsSettings.h"
+#include "GoogleAnalyticsTransport.h"
+#include "GoogleAnalyticsEventAttributes.h"
 
 #if PLATFORM_IOS
 #if WITH_GOOGLEANALYTICS
@@ -38,7 +40,7 @@ IMPLEMENT_MODULE(FAnalyticsGoogleAnalytics, GoogleAnalytics)
 TSharedPtr<IAnalyticsProvider> FAnalyticsProviderGoogleAnalytics::Provider;
 
 #if PLATFORM_ANDROID
-jintArray BuildCustomDimensionsIndexArray(const TArray<FCustomDimension>& CustomDimensions)
+jintArray BuildCustomDimensionsIndexArray(const TArrayView<const FCustomDimension> CustomDimensions)
 {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
@@ -55,7 +57,7 @@ jintArray BuildCustomDimensionsIndexArray(const TArray<FCustomDimension>& Custom
 	return NULL;
 }
 
-jobjectArray BuildCustomDimensionsValueArray(const TArray<FCustomDimension>& CustomDimensions)
+jobjectArray BuildCustomDimensionsValueArray(const TArrayView<const FCustomDimension> CustomDimensions)
 {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
@@ -72,7 +74,7 @@ jobjectArray BuildCustomDimensionsValueArray(const TArray<FCustomDimension>& Cus
 	return NULL;
 }
 
-jintArray BuildCustomMetricsIndexArray(const TArray<FCustomMetric>& CustomMetrics)
+jintArray BuildCustomMetricsIndexArray(const TArrayView<const FCustomMetric> CustomMetrics)
 {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
@@ -89,7 +91,7 @@ jintArray BuildCustomMetricsIndexArray(const TArray<FCustomMetric>& CustomMetric
 	return NULL;
 }
 
-jfloatArray BuildCustomMetricsValueArray(const TArray<FCustomMetric>& CustomMetrics)
+jfloatArray BuildCustomMetricsValueArray(const TArrayView<const FCustomMetric> CustomMetrics)
 {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
@@ -119,7 +121,7 @@ void AndroidThunkCpp_GoogleAnalyticsStartSession(FString& TrackingId, int32& Dis
 	}
 }
 
-void AndroidThunkCpp_GoogleAnalyticsRecordScreen(const FString& ScreenName, const TArray<FCustomDimension>& CustomDimensions, const TArray<FCustomMetric>& CustomMetrics)
+void AndroidThunkCpp_GoogleAnalyticsRecordScreen(const FString& ScreenName, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
 {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
@@ -140,7 +142,7 @@ void AndroidThunkCpp_GoogleAnalyticsRecordScreen(const FString& ScreenName, cons
 	}
 }
 
-void AndroidThunkCpp_GoogleAnalyticsRecordEvent(const FString& Category, const FString& Action, const FString& Label, const int32& Value, const TArray<FCustomDimension>& CustomDimensions, const TArray<FCustomMetric>& CustomMetrics)
+void AndroidThunkCpp_GoogleAnalyticsRecordEvent(const FString& Category, const FString& Action, const FString& Label, const int32& Value, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
 {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
@@ -208,7 +210,7 @@ void AndroidThunkCpp_GoogleAnalyticsSetLocation(const FString& Location) {
 	}
 }
 
-void AndroidThunkCpp_GoogleAnalyticsRecordError(const FString& Description, const TArray<FCustomDimension>& CustomDimensions, const TArray<FCustomMetric>& CustomMetrics) {
+void AndroidThunkCpp_GoogleAnalyticsRecordError(const FString& Description, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics) {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
 		jintArray CustomDimensionIndex = BuildCustomDimensionsIndexArray(CustomDimensions);
@@ -228,7 +230,7 @@ void AndroidThunkCpp_GoogleAnalyticsRecordError(const FString& Description, cons
 	}
 }
 
-void AndroidThunkCpp_GoogleAnalyticsRecordCurrencyPurchase(const FString& TransactionId, const FString& GameCurrencyType, const int32& GameCurrencyAmount, const FString& RealCurrencyType, const float& RealMoneyCost, const FString& PaymentProvider, const TArray<FCustomDimension>& CustomDimensions, const TArray<FCustomMetric>& CustomMetrics) {
+void AndroidThunkCpp_GoogleAnalyticsRecordCurrencyPurchase(const FString& TransactionId, const FString& GameCurrencyType, const int32& GameCurrencyAmount, const FString& RealCurrencyType, const float& RealMoneyCost, const FString& PaymentProvider, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics) {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
 		jintArray CustomDimensionIndex = BuildCustomDimensionsIndexArray(CustomDimensions);
@@ -254,7 +256,7 @@ void AndroidThunkCpp_GoogleAnalyticsRecordCurrencyPurchase(const FString& Transa
 	}
 }
 
-void AndroidThunkCpp_GoogleAnalyticsRecordSocialInteraction(const FString& Network, const FString& Action, const FString& Target, const TArray<FCustomDimension>& CustomDimensions, const TArray<FCustomMetric>& CustomMetrics)
+void AndroidThunkCpp_GoogleAnalyticsRecordSocialInteraction(const FString& Network, const FString& Action, const FString& Target, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
 {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
@@ -279,7 +281,7 @@ void AndroidThunkCpp_GoogleAnalyticsRecordSocialInteraction(const FString& Netwo
 	}
 }
 
-void AndroidThunkCpp_GoogleAnalyticsRecordUserTiming(const FString& Category, const int32& Value, const FString& Name, const TArray<FCustomDimension>& CustomDimensions, const TArray<FCustomMetric>& CustomMetrics)
+void AndroidThunkCpp_GoogleAnalyticsRecordUserTiming(const FString& Category, const int32& Value, const FString& Name, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
 {
 	if (JNIEnv* Env = FAndroidApplication::GetJavaEnv())
 	{
@@ -347,6 +349,33 @@ void FAnalyticsGoogleAnalytics::ShutdownModule()
 	}
 }
 
+void FAnalyticsGoogleAnalytics::SetTransport(const TSharedPtr<IGoogleAnalyticsTransport, ESPMode::ThreadSafe>& InTransport)
+{
+	TransportOverride = InTransport;
+}
+
+TSharedRef<IGoogleAnalyticsTransport, ESPMode::ThreadSafe> FAnalyticsGoogleAnalytics::CreateTransport() const
+{
+	if (TransportOverride.IsValid())
+	{
+		return TransportOverride.ToSharedRef();
+	}
+
+	const UGoogleAnalyticsSettings* Settings = GetDefault<UGoogleAnalyticsSettings>();
+
+	switch (Settings->Transport)
+	{
+	case EGoogleAnalyticsTransport::File:
+		return MakeShareable(new FGoogleAnalyticsFileTransport(FPaths::IsRelative(Settings->TransportFilename) ? FPaths::ProjectSavedDir() / Settings->TransportFilename : Settings->TransportFilename));
+	case EGoogleAnalyticsTransport::Memory:
+		return MakeShareable(new FGoogleAnalyticsMemoryTransport());
+	case EGoogleAnalyticsTransport::Null:
+		return MakeShareable(new FGoogleAnalyticsNullTransport());
+	default:
+		return MakeShareable(new FGoogleAnalyticsHttpTransport(Settings->CollectorUrl));
+	}
+}
+
 TSharedPtr<IAnalyticsProvider> FAnalyticsGoogleAnalytics::CreateAnalyticsProvider(const FAnalyticsProviderConfigurationDelegate& GetConfigValue) const
 {
 	if (GetConfigValue.IsBound())
@@ -377,10 +406,18 @@ TSharedPtr<IAnalyticsProvider> FAnalyticsGoogleAnalytics::CreateAnalyticsProvide
 FAnalyticsProviderGoogleAnalytics::FAnalyticsProviderGoogleAnalytics(const FString TrackingId, const int32 SendInterval) :
 	ApiTrackingId(TrackingId),
 	bHasSessionStarted(false),
-	bSessionStartedSent(false),
 	bAnonymizeIp(false),
 	Interval(SendInterval)
 {
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	Worker = MakeUnique<FGoogleAnalyticsWorker>(SendInterval);
+
+	SampledHitTypes.Set((1 << NumGoogleAnalyticsHitTypes) - 1);
+
+	// System info only changes with the viewport size and the culture
+	ViewportResizedHandle = FViewport::ViewportResizedEvent.AddRaw(this, &FAnalyticsProviderGoogleAnalytics::OnViewportResized);
+	CultureChangedHandle = FInternationalization::Get().OnCultureChanged().AddRaw(this, &FAnalyticsProviderGoogleAnalytics::RefreshSystemInfo);
+#endif
 }
 
 FAnalyticsProviderGoogleAnalytics::~FAnalyticsProviderGoogleAnalytics()
@@ -389,6 +426,14 @@ FAnalyticsProviderGoogleAnalytics::~FAnalyticsProviderGoogleAnalytics()
 	{
 		EndSession();
 	}
+
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	FViewport::ViewportResizedEvent.Remove(ViewportResizedHandle);
+	if (FInternationalization::IsAvailable())
+	{
+		FInternationalization::Get().OnCultureChanged().Remove(CultureChangedHandle);
+	}
+#endif
 }
 
 bool FAnalyticsProviderGoogleAnalytics::StartSession(const TArray<FAnalyticsEventAttribute>& Attributes)
@@ -450,6 +495,10 @@ bool FAnalyticsProviderGoogleAnalytics::StartSession(const TArray<FAnalyticsEven
 
 		GConfig->SetString(TEXT("GoogleAnalytics"), TEXT("UniversalCid"), *UniversalCid, GEngineIni);
 
+		UpdateSampling();
+		RefreshSystemInfo();
+		Worker->StartSession(ApiTrackingId, UniversalCid, bAnonymizeIp);
+
 		RecordScreen("Game Launched");
 #endif
 		if (Attributes.Num() > 0)
@@ -472,9 +521,11 @@ void FAnalyticsProviderGoogleAnalytics::EndSession()
 #else
 		UE_LOG(LogGoogleAnalytics, Warning, TEXT("WITH_GOOGLEANALYTICS=0. Are you missing the SDK?"));
 #endif
+#elif !PLATFORM_ANDROID
+		// Sends aggregated summaries and other held back hits with this session
+		Worker->Flush(0.0f);
 #endif
 		bHasSessionStarted = false;
-		bSessionStartedSent = false;
 		bAnonymizeIp = false;
 	}
 }
@@ -495,6 +546,13 @@ FString FAnalyticsProviderGoogleAnalytics::GetTrackingId()
 void FAnalyticsProviderGoogleAnalytics::SetAnonymizeIp(const bool Anonymize)
 {
 	bAnonymizeIp = Anonymize;
+
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	if (bHasSessionStarted)
+	{
+		Worker->SetAnonymizeIp(Anonymize);
+	}
+#endif
 }
 
 void FAnalyticsProviderGoogleAnalytics::SetOpenUrlIOS(const FString& OpenUrl)
@@ -521,24 +579,89 @@ FString FAnalyticsProviderGoogleAnalytics::GetSystemInfo()
 {
 	FString SystemInfo = FString("");
 
-	if (GEngine->GameViewport && GEngine->GameViewport->Viewport)
+	if (GEngine && GEngine->GameViewport && GEngine->GameViewport->Viewport)
 	{
-		const FVector2D ViewportSize = FVector2D(GEngine->GameViewport->Viewport->GetSizeXY());
-		SystemInfo += FString("&ul=" + FInternationalization::Get().GetCurrentCulture()->GetName() + "&ua=Windows&sr=" + FString::FromInt(ViewportSize.X) + "x" + FString::FromInt(ViewportSize.Y) + "&vp=" + FString::FromInt(ViewportSize.X) + "x" + FString::FromInt(ViewportSize.Y));
+		const FIntPoint ViewportSize = GEngine->GameViewport->Viewport->GetSizeXY();
+		const FString Resolution = FString::FromInt(ViewportSize.X) + "x" + FString::FromInt(ViewportSize.Y);
+		SystemInfo += FString("&ul=" + FPlatformHttp::UrlEncode(FInternationalization::Get().GetCurrentCulture()->GetName()) + "&ua=" + FPlatformHttp::UrlEncode(GetUserAgent()) + "&sr=" + Resolution + "&vp=" + Resolution);
 	}
 
-	if (!bSessionStartedSent)
+	return SystemInfo;
+}
+
+FString FAnalyticsProviderGoogleAnalytics::GetUserAgent()
+{
+#if PLATFORM_WINDOWS
+	return FString("Windows");
+#elif PLATFORM_MAC
+	return FString("Macintosh");
+#elif PLATFORM_LINUX
+	return FString("Linux");
+#else
+	return FString(FPlatformProperties::IniPlatformName());
+#endif
+}
+
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+void FAnalyticsProviderGoogleAnalytics::RefreshSystemInfo()
+{
+	// Engine state can only be queried on the game thread, hits keep using the cached system info until the next refresh
+	if (IsInGameThread())
 	{
-		bSessionStartedSent = true;
-		SystemInfo += "&sc=start";
+		FString SystemInfo = GetSystemInfo();
+		if (SystemInfo != LastSystemInfo)
+		{
+			LastSystemInfo = SystemInfo;
+			Worker->SetSystemInfo(SystemInfo);
+		}
 	}
+}
 
-	if(bAnonymizeIp)
+void FAnalyticsProviderGoogleAnalytics::OnViewportResized(FViewport* Viewport, uint32 Unused)
+{
+	if (GEngine && GEngine->GameViewport && GEngine->GameViewport->Viewport == Viewport)
 	{
-		SystemInfo += "&aip=1";
+		RefreshSystemInfo();
 	}
+}
+#endif
 
-	return SystemInfo;
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+void FAnalyticsProviderGoogleAnalytics::UpdateSampling()
+{
+	const UGoogleAnalyticsSettings* DefaultSettings = GetDefault<UGoogleAnalyticsSettings>();
+
+	// Same client id, same bucket: a client is consistently in or out of every sample
+	const uint32 Bucket = FCrc::StrCrc32(*UniversalCid) % 10000;
+	const auto IsBucketSampled = [Bucket](const float SampleRate)
+	{
+		return Bucket < (uint32)FMath::Clamp(FMath::RoundToInt(SampleRate * 100.0f), 0, 10000);
+	};
+
+	const auto HitTypeBit = [](const EGoogleAnalyticsHitType Type)
+	{
+		return 1 << (int32)Type;
+	};
+
+	// Revenue and error reports are high priority and never sampled
+	int32 Sampled = HitTypeBit(EGoogleAnalyticsHitType::Transaction) | HitTypeBit(EGoogleAnalyticsHitType::Item) | HitTypeBit(EGoogleAnalyticsHitType::Exception);
+	Sampled |= IsBucketSampled(DefaultSettings->EventSampleRate) ? HitTypeBit(EGoogleAnalyticsHitType::Event) : 0;
+	Sampled |= IsBucketSampled(DefaultSettings->PageviewSampleRate) ? HitTypeBit(EGoogleAnalyticsHitType::Pageview) : 0;
+	Sampled |= IsBucketSampled(DefaultSettings->SocialSampleRate) ? HitTypeBit(EGoogleAnalyticsHitType::Social) : 0;
+	Sampled |= IsBucketSampled(DefaultSettings->TimingSampleRate) ? HitTypeBit(EGoogleAnalyticsHitType::Timing) : 0;
+
+	SampledHitTypes.Set(Sampled);
+}
+#endif
+
+bool FAnalyticsProviderGoogleAnalytics::IsSampledIn(const EGoogleAnalyticsHitType Type) const
+{
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	return (SampledHitTypes.GetValue() & (1 << (int32)Type)) != 0;
+#else
+	// Native SDKs do their own sampling
+	return true;
+#endif
 }
 
 void FAnalyticsProviderGoogleAnalytics::FlushEvents()
@@ -553,10 +676,49 @@ void FAnalyticsProviderGoogleAnalytics::FlushEvents()
 #endif
 #elif PLATFORM_ANDROID
 		AndroidThunkCpp_GoogleAnalyticsFlushEvents();
+#else
+		Worker->Flush(0.0f);
 #endif
 	}
 }
 
+bool FAnalyticsProviderGoogleAnalytics::FlushEventsAndWait(const float TimeoutSeconds)
+{
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	return Worker->Flush(TimeoutSeconds);
+#else
+	FlushEvents();
+	return true;
+#endif
+}
+
+int32 FAnalyticsProviderGoogleAnalytics::GetNumOverflowedHits() const
+{
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	return Worker->GetNumOverflowedHits();
+#else
+	return 0;
+#endif
+}
+
+int32 FAnalyticsProviderGoogleAnalytics::GetNumRateLimitDroppedHits() const
+{
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	return Worker->GetNumRateLimitDroppedHits();
+#else
+	return 0;
+#endif
+}
+
+int32 FAnalyticsProviderGoogleAnalytics::GetNumRateLimitDeferredHits() const
+{
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	return Worker->GetNumRateLimitDeferredHits();
+#else
+	return 0;
+#endif
+}
+
 void FAnalyticsProviderGoogleAnalytics::SetUserID(const FString& InUserId)
 {
 	if (bHasSessionStarted)
@@ -575,7 +737,11 @@ void FAnalyticsProviderGoogleAnalytics::SetUserID(const FString& InUserId)
 #elif PLATFORM_ANDROID
 		AndroidThunkCpp_GoogleAnalyticsSetUserId(InUserId);
 #else
-		UserId = InUserId;
+		{
+			FScopeLock ScopeLock(&UserIdLock);
+			UserId = InUserId;
+		}
+		Worker->SetUserId(InUserId);
 #endif
 	}
 }
@@ -602,6 +768,7 @@ FString FAnalyticsProviderGoogleAnalytics::GetUserID() const
 #elif PLATFORM_ANDROID
 		return AndroidThunkCpp_GoogleAnalyticsGetUserId();
 #else
+		FScopeLock ScopeLock(&UserIdLock);
 		return UserId;
 #endif
 	}
@@ -612,9 +779,7 @@ void FAnalyticsProviderGoogleAnalytics::SetGender(const FString& InGender)
 {
 	if (bHasSessionStarted)
 	{
-		TArray<FAnalyticsEventAttribute> Params;
-		Params.Add(FAnalyticsEventAttribute(TEXT("Category"), TEXT("Gender")));
-		RecordEvent(InGender, Params);
+		RecordEvent(TEXT("Gender"), InGender, FString(), 0.0f);
 	}
 }
 
@@ -622,10 +787,7 @@ void FAnalyticsProviderGoogleAnalytics::SetAge(const int32 InAge)
 {
 	if (bHasSessionStarted)
 	{
-		TArray<FAnalyticsEventAttribute> Params;
-		Params.Add(FAnalyticsEventAttribute(TEXT("Category"), TEXT("Age")));
-		Params.Add(FAnalyticsEventAttribute(TEXT("Value"), InAge));
-		RecordEvent(FString::FromInt(InAge), Params);
+		RecordEvent(TEXT("Age"), FString::FromInt(InAge), FString(), InAge);
 	}
 }
 
@@ -647,7 +809,7 @@ void FAnalyticsProviderGoogleAnalytics::SetLocation(const FString& InLocation)
 #elif PLATFORM_ANDROID
 		AndroidThunkCpp_GoogleAnalyticsSetLocation(InLocation);
 #else 
-		Location = InLocation;
+		Worker->SetLocation(InLocation);
 #endif
 	}
 }
@@ -670,33 +832,48 @@ bool FAnalyticsProviderGoogleAnalytics::SetSessionID(const FString& InSessionID)
 
 void FAnalyticsProviderGoogleAnalytics::RecordEvent(const FString& EventName, const TArray<FAnalyticsEventAttribute>& Attributes)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Event))
 	{
 		if (EventName.Len() > 0)
 		{
-			FString Action = FString(EventName);
-			FString Category = FString("Default Category");
-			FString Label = FString("");
-			float Value = 0;
+			const FGoogleAnalyticsEventAttributes EventAttributes(Attributes);
+			const FString* Category = EventAttributes.Find(EGoogleAnalyticsAttribute::Category);
+			const FString* Label = EventAttributes.Find(EGoogleAnalyticsAttribute::Label);
 
-			for (int i = 0; i < Attributes.Num(); i++)
+			RecordEvent(Category ? *Category : FString(), EventName, Label ? *Label : FString(), EventAttributes.GetFloat(EGoogleAnalyticsAttribute::Value), EventAttributes.CustomDimensions, EventAttributes.CustomMetrics);
+		}
+	}
+}
+
+void FAnalyticsProviderGoogleAnalytics::RecordEvent(const FString& Category, const FString& Action, const FString& Label, const float Value, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
+{
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Event))
+	{
+		if (Action.Len() > 0)
+		{
+			static const FString DefaultCategory(TEXT("Default Category"));
+			const FString& EventCategory = Category.Len() > 0 ? Category : DefaultCategory;
+
+			// An empty value would clear a session or user scoped dimension, they are skipped like attribute based events do
+			bool bHasEmptyDimension = false;
+			for (const FCustomDimension& CustomDimension : CustomDimensions)
 			{
-				if (Attributes[i].AttrName.Equals("Category") && Attributes[i].ToString().Len() > 0)
-				{
-					Category = Attributes[i].ToString();
-				}
-				else if (Attributes[i].AttrName.Equals("Label") && Attributes[i].ToString().Len() > 0)
-				{
-					Label = Attributes[i].ToString();
-				}
-				else if (Attributes[i].AttrName.Equals("Value"))
+				bHasEmptyDimension |= CustomDimension.Value.IsEmpty();
+			}
+
+			TArray<FCustomDimension, TInlineAllocator<4>> NonEmptyDimensions;
+			if (bHasEmptyDimension)
+			{
+				for (const FCustomDimension& CustomDimension : CustomDimensions)
 				{
-					Value = FCString::Atof(*Attributes[i].ToString());
+					if (!CustomDimension.Value.IsEmpty())
+					{
+						NonEmptyDimensions.Add(CustomDimension);
+					}
 				}
 			}
 
-			const TArray<FCustomDimension> CustomDimensions = BuildCustomDimensionsFromAttributes(Attributes);
-			const TArray<FCustomMetric> CustomMetrics = BuildCustomMetricsFromAttributes(Attributes);
+			const TArrayView<const FCustomDimension> EventDimensions = bHasEmptyDimension ? TArrayView<const FCustomDimension>(NonEmptyDimensions) : CustomDimensions;
 
 #if PLATFORM_IOS
 #if WITH_GOOGLEANALYTICS
@@ -705,10 +882,10 @@ void FAnalyticsProviderGoogleAnalytics::RecordEvent(const FString& EventName, co
 
 			if (tracker != nil)
 			{
-				tracker = BuildCustomDimensionsAndMetrics(tracker, CustomDimensions, CustomMetrics);
+				tracker = BuildCustomDimensionsAndMetrics(tracker, EventDimensions, CustomMetrics);
 
-				[tracker send : [[GAIDictionaryBuilder createEventWithCategory : Category.GetNSString()
-					action : EventName.GetNSString()
+				[tracker send : [[GAIDictionaryBuilder createEventWithCategory : EventCategory.GetNSString()
+					action : Action.GetNSString()
 					label : EventLabel
 					value : @(Value)] build]];
 			}
@@ -716,20 +893,22 @@ void FAnalyticsProviderGoogleAnalytics::RecordEvent(const FString& EventName, co
 			UE_LOG(LogGoogleAnalytics, Warning, TEXT("WITH_GOOGLEANALYTICS=0. Are you missing the SDK?"));
 #endif
 #elif PLATFORM_ANDROID
-			AndroidThunkCpp_GoogleAnalyticsRecordEvent(Category, EventName, Label, Value, CustomDimensions, CustomMetrics);
+			AndroidThunkCpp_GoogleAnalyticsRecordEvent(EventCategory, Action, Label, Value, EventDimensions, CustomMetrics);
 #else
-			TSharedRef<IHttpRequest> HttpRequest = FHttpModule::Get().CreateRequest();
-			HttpRequest->SetURL("https://www.google-analytics.com/collect?v=1&t=event&tid=" + ApiTrackingId + "&cid=" + UniversalCid + "&ec=" + FPlatformHttp::UrlEncode(Category) + "&ea=" + FPlatformHttp::UrlEncode(Action) + "&el=" + FPlatformHttp::UrlEncode(Label) + "&ev=" + FString::FromInt(Value) + "&geoid=" + Location + "&uid=" + UserId + BuildCustomDimensions(CustomDimensions) + BuildCustomMetrics(CustomMetrics) + GetSystemInfo());
-			HttpRequest->SetVerb("GET");
-			HttpRequest->ProcessRequest();
+			FGoogleAnalyticsHitRecord Hit(EGoogleAnalyticsHitType::Event, EventDimensions, CustomMetrics);
+			Hit.Text[0] = EventCategory;
+			Hit.Text[1] = Action;
+			Hit.Text[2] = Label;
+			Hit.Number[0] = Value;
+			Worker->RecordHit(MoveTemp(Hit));
 #endif
 		}
 	}
 }
 
-void FAnalyticsProviderGoogleAnalytics::RecordScreen(const FString& ScreenName, const TArray<FCustomDimension> CustomDimensions, const TArray<FCustomMetric> CustomMetrics)
+void FAnalyticsProviderGoogleAnalytics::RecordScreen(const FString& ScreenName, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Pageview))
 	{
 		if (ScreenName.Len() > 0)
 		{
@@ -749,18 +928,17 @@ void FAnalyticsProviderGoogleAnalytics::RecordScreen(const FString& ScreenName,
 #elif PLATFORM_ANDROID
 			AndroidThunkCpp_GoogleAnalyticsRecordScreen(ScreenName, CustomDimensions, CustomMetrics);
 #else
-			TSharedRef<IHttpRequest> HttpRequest = FHttpModule::Get().CreateRequest();
-			HttpRequest->SetURL("https://www.google-analytics.com/collect?v=1&t=pageview&tid=" + ApiTrackingId + "&cid=" + UniversalCid + "&dp=" + FPlatformHttp::UrlEncode(ScreenName) + "&dt=" + FPlatformHttp::UrlEncode(ScreenName) + "&geoid=" + Location + "&uid=" + UserId + BuildCustomDimensions(CustomDimensions) + BuildCustomMetrics(CustomMetrics) + GetSystemInfo());
-			HttpRequest->SetVerb("GET");
-			HttpRequest->ProcessRequest();
+			FGoogleAnalyticsHitRecord Hit(EGoogleAnalyticsHitType::Pageview, CustomDimensions, CustomMetrics);
+			Hit.Text[0] = ScreenName;
+			Worker->RecordHit(MoveTemp(Hit));
 #endif
 		}
 	}
 }
 
-void FAnalyticsProviderGoogleAnalytics::RecordSocialInteraction(const FString& Network, const FString& Action, const FString& Target, const TArray<FCustomDimension> CustomDimensions, const TArray<FCustomMetric> CustomMetrics)
+void FAnalyticsProviderGoogleAnalytics::RecordSocialInteraction(const FString& Network, const FString& Action, const FString& Target, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Social))
 	{
 		if (Network.Len() > 0 && Action.Len() > 0)
 		{
@@ -781,18 +959,19 @@ void FAnalyticsProviderGoogleAnalytics::RecordSocialInteraction(const FString& N
 #elif PLATFORM_ANDROID
 			AndroidThunkCpp_GoogleAnalyticsRecordSocialInteraction(Network, Action, Target, CustomDimensions, CustomMetrics);
 #else
-			TSharedRef<IHttpRequest> HttpRequest = FHttpModule::Get().CreateRequest();
-			HttpRequest->SetURL("https://www.google-analytics.com/collect?v=1&t=social&tid=" + ApiTrackingId + "&cid=" + UniversalCid + "&geoid=" + Location + "&uid=" + UserId + "&sn=" + FPlatformHttp::UrlEncode(Network) + "&sa=" + FPlatformHttp::UrlEncode(Action) + "&st=" + FPlatformHttp::UrlEncode(Target) + BuildCustomDimensions(CustomDimensions) + BuildCustomMetrics(CustomMetrics) + GetSystemInfo());
-			HttpRequest->SetVerb("GET");
-			HttpRequest->ProcessRequest();
+			FGoogleAnalyticsHitRecord Hit(EGoogleAnalyticsHitType::Social, CustomDimensions, CustomMetrics);
+			Hit.Text[0] = Network;
+			Hit.Text[1] = Action;
+			Hit.Text[2] = Target;
+			Worker->RecordHit(MoveTemp(Hit));
 #endif
 		}
 	}
 }
 
-void FAnalyticsProviderGoogleAnalytics::RecordUserTiming(const FString& Category, const int32 Value, const FString& Name, const TArray<FCustomDimension> CustomDimensions, const TArray<FCustomMetric> CustomMetrics)
+void FAnalyticsProviderGoogleAnalytics::RecordUserTiming(const FString& Category, const int32 Value, const FString& Name, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Timing))
 	{
 		if (Category.Len() > 0)
 		{
@@ -812,10 +991,11 @@ void FAnalyticsProviderGoogleAnalytics::RecordUserTiming(const FString& Category
 #elif PLATFORM_ANDROID
 			AndroidThunkCpp_GoogleAnalyticsRecordUserTiming(Category, Value, Name, CustomDimensions, CustomMetrics);
 #else
-			TSharedRef<IHttpRequest> HttpRequest = FHttpModule::Get().CreateRequest();
-			HttpRequest->SetURL("https://www.google-analytics.com/collect?v=1&t=timing&tid=" + ApiTrackingId + "&cid=" + UniversalCid + "&geoid=" + Location + "&uid=" + UserId + "&utc=" + FPlatformHttp::UrlEncode(Category) + "&utv=" + FPlatformHttp::UrlEncode(Name) + "&utt=" + FString::FromInt(Value) + BuildCustomDimensions(CustomDimensions) + BuildCustomMetrics(CustomMetrics) + GetSystemInfo());
-			HttpRequest->SetVerb("GET");
-			HttpRequest->ProcessRequest();
+			FGoogleAnalyticsHitRecord Hit(EGoogleAnalyticsHitType::Timing, CustomDimensions, CustomMetrics);
+			Hit.Text[0] = Category;
+			Hit.Text[1] = Name;
+			Hit.Number[0] = Value;
+			Worker->RecordHit(MoveTemp(Hit));
 #endif
 		}
 	}
@@ -823,61 +1003,32 @@ void FAnalyticsProviderGoogleAnalytics::RecordUserTiming(const FString& Category
 
 void FAnalyticsProviderGoogleAnalytics::RecordItemPurchase(const FString& ItemId, int ItemQuantity, const TArray<FAnalyticsEventAttribute>& EventAttrs)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Event))
 	{
-		FString Currency = FString("");
-		int32 PerItemCost = 0;
+		const FGoogleAnalyticsEventAttributes EventAttributes(EventAttrs);
+		const FString Currency = EventAttributes.GetString(EGoogleAnalyticsAttribute::Currency, TEXT(""));
+		const int32 PerItemCost = EventAttributes.GetInt(EGoogleAnalyticsAttribute::PerItemCost);
 
-		for (int i = 0; i < EventAttrs.Num(); i++)
-		{
-			if (EventAttrs[i].AttrName.Equals("Currency") && EventAttrs[i].ToString().Len() > 0)
-			{
-				Currency = EventAttrs[i].ToString();
-			}
-			if (EventAttrs[i].AttrName.Equals("PerItemCost"))
-			{
-				PerItemCost = FCString::Atoi(*EventAttrs[i].ToString());
-			}
-		}
-
-		TArray<FAnalyticsEventAttribute> Params;
-		Params.Add(FAnalyticsEventAttribute(TEXT("Category"), TEXT("Item Purchase")));
-		Params.Add(FAnalyticsEventAttribute(TEXT("Label"), FString::Printf(TEXT("Cost: %d %s"), PerItemCost, *Currency)));
-		Params.Add(FAnalyticsEventAttribute(TEXT("Value"), ItemQuantity));
-		RecordEvent(ItemId, Params);
+		RecordEvent(TEXT("Item Purchase"), ItemId, FString::Printf(TEXT("Cost: %d %s"), PerItemCost, *Currency), ItemQuantity);
 	}
 }
 
 void FAnalyticsProviderGoogleAnalytics::RecordCurrencyPurchase(const FString& GameCurrencyType, int GameCurrencyAmount, const TArray<FAnalyticsEventAttribute>& EventAttrs)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Transaction))
 	{
 		if (GameCurrencyType.Len() > 0)
 		{
-			FString RealCurrencyType = FString("USD");
-			float RealMoneyCost = 0;
-			FString PaymentProvider = FString("Default Provider");
-
-			for (int i = 0; i < EventAttrs.Num(); i++)
-			{
-				if (EventAttrs[i].AttrName.Equals("RealCurrencyType") && EventAttrs[i].ToString().Len() > 0)
-				{
-					RealCurrencyType = EventAttrs[i].ToString();
-				}
-				if (EventAttrs[i].AttrName.Equals("RealMoneyCost") && EventAttrs[i].ToString().Len() > 0)
-				{
-					RealMoneyCost = FCString::Atof(*EventAttrs[i].ToString());
-				}
-				if (EventAttrs[i].AttrName.Equals("PaymentProvider") && EventAttrs[i].ToString().Len() > 0)
-				{
-					PaymentProvider = EventAttrs[i].ToString();
-				}
-			}
+			const FGoogleAnalyticsEventAttributes EventAttributes(EventAttrs);
+			const FString RealCurrencyType = EventAttributes.GetString(EGoogleAnalyticsAttribute::RealCurrencyType, TEXT("USD"));
+			const float RealMoneyCost = EventAttributes.GetFloat(EGoogleAnalyticsAttribute::RealMoneyCost);
+			const FString PaymentProvider = EventAttributes.GetString(EGoogleAnalyticsAttribute::PaymentProvider, TEXT("Default Provider"));
 
-			FString TransactionId = FMD5::HashAnsiString(*(GameCurrencyType + RealCurrencyType + PaymentProvider + FDateTime::Now().ToString()));
+			// Unique per purchase and generated once, so a resent hit is deduplicated instead of counted twice
+			const FString TransactionId = FGuid::NewGuid().ToString(EGuidFormats::Digits);
 
-			const TArray<FCustomDimension> CustomDimensions = BuildCustomDimensionsFromAttributes(EventAttrs);
-			const TArray<FCustomMetric> CustomMetrics = BuildCustomMetricsFromAttributes(EventAttrs);
+			const TArrayView<const FCustomDimension> CustomDimensions = EventAttributes.CustomDimensions;
+			const TArrayView<const FCustomMetric> CustomMetrics = EventAttributes.CustomMetrics;
 
 #if PLATFORM_IOS
 #if WITH_GOOGLEANALYTICS
@@ -908,15 +1059,21 @@ void FAnalyticsProviderGoogleAnalytics::RecordCurrencyPurchase(const FString& Ga
 #elif PLATFORM_ANDROID
 			AndroidThunkCpp_GoogleAnalyticsRecordCurrencyPurchase(TransactionId, GameCurrencyType, GameCurrencyAmount, RealCurrencyType, RealMoneyCost, PaymentProvider, CustomDimensions, CustomMetrics);
 #else
-			TSharedRef<IHttpRequest> HttpRequestTransaction = FHttpModule::Get().CreateRequest();
-			HttpRequestTransaction->SetURL("https://www.google-analytics.com/collect?v=1&t=transaction&tid=" + ApiTrackingId + "&cid=" + UniversalCid + "&geoid=" + Location + "&uid=" + UserId + "&ti=" + TransactionId + "&ta=" + PaymentProvider + "&tr=" + FString::SanitizeFloat(RealMoneyCost) + "&ts=0&tt=0&cu=" + RealCurrencyType + BuildCustomDimensions(CustomDimensions) + BuildCustomMetrics(CustomMetrics) + GetSystemInfo());
-			HttpRequestTransaction->SetVerb("GET");
-			HttpRequestTransaction->ProcessRequest();
-
-			TSharedRef<IHttpRequest> HttpRequestItem = FHttpModule::Get().CreateRequest();
-			HttpRequestItem->SetURL("https://www.google-analytics.com/collect?v=1&t=item&tid=" + ApiTrackingId + "&cid=" + UniversalCid + "&geoid=" + Location + "&uid=" + UserId + "&ti=" + TransactionId + "&in=" + GameCurrencyType + "&ip=" + FString::SanitizeFloat(RealMoneyCost / GameCurrencyAmount) + "&iq=" + FString::FromInt(GameCurrencyAmount) + "&iv=" + PaymentProvider + "&ic=" + GameCurrencyType + "&cu=" + RealCurrencyType + BuildCustomDimensions(CustomDimensions) + BuildCustomMetrics(CustomMetrics) + GetSystemInfo());
-			HttpRequestItem->SetVerb("GET");
-			HttpRequestItem->ProcessRequest();
+			FGoogleAnalyticsHitRecord TransactionHit(EGoogleAnalyticsHitType::Transaction, CustomDimensions, CustomMetrics);
+			TransactionHit.Text[0] = TransactionId;
+			TransactionHit.Text[1] = PaymentProvider;
+			TransactionHit.Text[2] = RealCurrencyType;
+			TransactionHit.Number[0] = RealMoneyCost;
+			Worker->RecordHit(MoveTemp(TransactionHit));
+
+			FGoogleAnalyticsHitRecord ItemHit(EGoogleAnalyticsHitType::Item, CustomDimensions, CustomMetrics);
+			ItemHit.Text[0] = TransactionId;
+			ItemHit.Text[1] = GameCurrencyType;
+			ItemHit.Text[2] = PaymentProvider;
+			ItemHit.Text[3] = RealCurrencyType;
+			ItemHit.Number[0] = RealMoneyCost / GameCurrencyAmount;
+			ItemHit.Number[1] = GameCurrencyAmount;
+			Worker->RecordHit(MoveTemp(ItemHit));
 #endif
 		}
 	}
@@ -924,23 +1081,21 @@ void FAnalyticsProviderGoogleAnalytics::RecordCurrencyPurchase(const FString& Ga
 
 void FAnalyticsProviderGoogleAnalytics::RecordCurrencyGiven(const FString& GameCurrencyType, int GameCurrencyAmount, const TArray<FAnalyticsEventAttribute>& EventAttrs)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Event))
 	{
-		TArray<FAnalyticsEventAttribute> Params;
-		Params.Add(FAnalyticsEventAttribute(TEXT("Category"), TEXT("Currency Given")));
-		Params.Add(FAnalyticsEventAttribute(TEXT("Value"), GameCurrencyAmount));
-		RecordEvent(GameCurrencyType, Params);
+		RecordEvent(TEXT("Currency Given"), GameCurrencyType, FString(), GameCurrencyAmount);
 	}
 }
 
 void FAnalyticsProviderGoogleAnalytics::RecordError(const FString& Error, const TArray<FAnalyticsEventAttribute>& EventAttrs)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Exception))
 	{
 		if (Error.Len() > 0)
 		{
-			const TArray<FCustomDimension> CustomDimensions = BuildCustomDimensionsFromAttributes(EventAttrs);
-			const TArray<FCustomMetric> CustomMetrics = BuildCustomMetricsFromAttributes(EventAttrs);
+			const FGoogleAnalyticsEventAttributes EventAttributes(EventAttrs);
+			const TArrayView<const FCustomDimension> CustomDimensions = EventAttributes.CustomDimensions;
+			const TArrayView<const FCustomMetric> CustomMetrics = EventAttributes.CustomMetrics;
 
 #if PLATFORM_IOS
 #if WITH_GOOGLEANALYTICS
@@ -960,10 +1115,9 @@ void FAnalyticsProviderGoogleAnalytics::RecordError(const FString& Error, const
 #elif PLATFORM_ANDROID
 			AndroidThunkCpp_GoogleAnalyticsRecordError(Error, CustomDimensions, CustomMetrics);
 #else
-			TSharedRef<IHttpRequest> HttpRequest = FHttpModule::Get().CreateRequest();
-			HttpRequest->SetURL("https://www.google-analytics.com/collect?v=1&t=exception&tid=" + ApiTrackingId + "&cid=" + UniversalCid + "&geoid=" + Location + "&uid=" + UserId + "&exd=" + Error + "&exf=0" + BuildCustomDimensions(CustomDimensions) + BuildCustomMetrics(CustomMetrics) + GetSystemInfo());
-			HttpRequest->SetVerb("GET");
-			HttpRequest->ProcessRequest();
+			FGoogleAnalyticsHitRecord Hit(EGoogleAnalyticsHitType::Exception, CustomDimensions, CustomMetrics);
+			Hit.Text[0] = Error;
+			Worker->RecordHit(MoveTemp(Hit));
 #endif
 		}
 	}
@@ -971,7 +1125,7 @@ void FAnalyticsProviderGoogleAnalytics::RecordError(const FString& Error, const
 
 void FAnalyticsProviderGoogleAnalytics::RecordProgress(const FString& ProgressType, const TArray<FString>& ProgressHierarchy, const TArray<FAnalyticsEventAttribute>& EventAttrs)
 {
-	if (bHasSessionStarted)
+	if (bHasSessionStarted && IsSampledIn(EGoogleAnalyticsHitType::Event))
 	{
 		FString Hierarchy;
 
@@ -984,15 +1138,12 @@ void FAnalyticsProviderGoogleAnalytics::RecordProgress(const FString& ProgressTy
 			}
 		}
 
-		TArray<FAnalyticsEventAttribute> Params;
-		Params.Add(FAnalyticsEventAttribute(TEXT("Category"), TEXT("Progression")));
-		Params.Add(FAnalyticsEventAttribute(TEXT("Label"), Hierarchy));
-		RecordEvent(ProgressType, Params);
+		RecordEvent(TEXT("Progression"), ProgressType, Hierarchy, 0.0f);
 	}
 }
 
 #if PLATFORM_IOS && WITH_GOOGLEANALYTICS
-id<GAITracker> FAnalyticsProviderGoogleAnalytics::BuildCustomDimensionsAndMetrics(id<GAITracker> tracker, const TArray<FCustomDimension> CustomDimensions, const TArray<FCustomMetric> CustomMetrics)
+id<GAITracker> FAnalyticsProviderGoogleAnalytics::BuildCustomDimensionsAndMetrics(id<GAITracker> tracker, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics)
 {
 	for (int i = 0; i < CustomDimensions.Num(); i++)
 	{
@@ -1007,77 +1158,3 @@ id<GAITracker> FAnalyticsProviderGoogleAnalytics::BuildCustomDimensionsAndMetric
 	return tracker;
 }
 #endif
-
-FString FAnalyticsProviderGoogleAnalytics::BuildCustomDimensions(const TArray<FCustomDimension> CustomDimensions)
-{
-	FString Result = FString();
-
-	for (auto& CustomDimension : CustomDimensions)
-	{
-		Result += "&cd" + FString::FromInt(CustomDimension.Index) + "=" + CustomDimension.Value;
-	}
-
-	return Result;
-}
-
-FString FAnalyticsProviderGoogleAnalytics::BuildCustomMetrics(const TArray<FCustomMetric> CustomMetrics)
-{
-	FString Result = FString();
-
-	for (auto& CustomMetric : CustomMetrics)
-	{
-		Result += "&cm" + FString::FromInt(CustomMetric.Index) + "=" + FString::SanitizeFloat(CustomMetric.Value);
-	}
-
-	return Result;
-}
-
-const TArray<FCustomDimension> FAnalyticsProviderGoogleAnalytics::BuildCustomDimensionsFromAttributes(const TArray<FAnalyticsEventAttribute>& Attributes)
-{
-	TArray<FCustomDimension> CustomDimensions;
-
-	for (int i = 0; i < Attributes.Num(); i++)
-	{
-		FString AttributeName = Attributes[i].AttrName;
-		if (AttributeName.Contains("CustomDimension") && Attributes[i].ToString().Len() > 0)
-		{
-			AttributeName = AttributeName.Replace(*FString("CustomDimension"), *FString(""));
-
-			if (AttributeName.IsNumeric())
-			{
-				FCustomDimension CustomDimension;
-				CustomDimension.Index = FCString::Atoi(*AttributeName);
-				CustomDimension.Value = Attributes[i].ToString();
-
-				CustomDimensions.Add(CustomDimension);
-			}
-		}
-	}
-
-	return CustomDimensions;
-}
-
-const TArray<FCustomMetric> FAnalyticsProviderGoogleAnalytics::BuildCustomMetricsFromAttributes(const TArray<FAnalyticsEventAttribute>& Attributes)
-{
-	TArray<FCustomMetric> CustomMetrics;
-
-	for (int i = 0; i < Attributes.Num(); i++)
-	{
-		FString AttributeName = Attributes[i].AttrName;
-		if (AttributeName.Contains("CustomMetric") && Attributes[i].ToString().Len() > 0)
-		{
-			AttributeName = AttributeName.Replace(*FString("CustomMetric"), *FString(""));
-
-			if (AttributeName.IsNumeric() && Attributes[i].ToString().IsNumeric())
-			{
-				FCustomMetric CustomMetric;
-				CustomMetric.Index = FCString::Atoi(*AttributeName);
-				CustomMetric.Value = FCString::Atof(*Attributes[i].ToString());
-
-				CustomMetrics.Add(CustomMetric);
-			}
-		}
-	}
-
-	return CustomMetrics;
-}
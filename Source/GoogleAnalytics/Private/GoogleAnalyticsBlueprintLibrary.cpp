@@ -32,21 +32,7 @@ void UGoogleAnalyticsBlueprintLibrary::RecordGoogleEvent(const FString& EventCat
 	TSharedPtr<FAnalyticsProviderGoogleAnalytics> Provider = FAnalyticsProviderGoogleAnalytics::GetProvider();
 	if (Provider.IsValid())
 	{
-		TArray<FAnalyticsEventAttribute> Params;
-		Params.Add(FAnalyticsEventAttribute(TEXT("Category"), EventCategory));
-		Params.Add(FAnalyticsEventAttribute(TEXT("Label"), EventLabel));
-		Params.Add(FAnalyticsEventAttribute(TEXT("Value"), EventValue));
-
-		for (int i = 0; i < CustomDimensions.Num(); i++)
-		{
-			Params.Add(FAnalyticsEventAttribute(TEXT("CustomDimension") + FString::FromInt(CustomDimensions[i].Index), CustomDimensions[i].Value));
-		}
-		for (int i = 0; i < CustomMetrics.Num(); i++)
-		{
-			Params.Add(FAnalyticsEventAttribute(TEXT("CustomMetric") + FString::FromInt(CustomMetrics[i].Index), FString::SanitizeFloat(CustomMetrics[i].Value)));
-		}
-
-		Provider->RecordEvent(EventAction, Params);
+		Provider->RecordEvent(EventCategory, EventAction, EventLabel, EventValue, CustomDimensions, CustomMetrics);
 	}
 }
 
@@ -117,3 +103,14 @@ void UGoogleAnalyticsBlueprintLibrary::SetAnonymizeIP(const bool Anonymize)
 		Provider->SetAnonymizeIp(Anonymize);
 	}
 }
+
+/** Sends all pending hits, waiting up to MaxWaitSeconds for them to be delivered (only for Google Analytics) */
+bool UGoogleAnalyticsBlueprintLibrary::FlushGoogleEvents(const float MaxWaitSeconds)
+{
+	TSharedPtr<FAnalyticsProviderGoogleAnalytics> Provider = FAnalyticsProviderGoogleAnalytics::GetProvider();
+	if (Provider.IsValid())
+	{
+		return Provider->FlushEventsAndWait(MaxWaitSeconds);
+	}
+	return true;
+}
@@ -0,0 +1,679 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsDispatcher.h"
+#include "GoogleAnalytics.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/Paths.h"
+#include "GoogleAnalyticsSettings.h"
+
+FGoogleAnalyticsDispatcher::FGoogleAnalyticsDispatcher(const int32 SendInterval) :
+	PendingBytes(0),
+	Interval(FMath::Max(SendInterval, 0)),
+	TimeSinceDispatch(0.0f),
+	bFlushing(false),
+	bShuttingDown(false),
+	bRestoredPersistedHits(false),
+	NextHitId(1),
+	CompressionFlags(COMPRESS_None),
+	CompressionThreshold(0),
+	RateLimitTokens(0.0f),
+	RateLimitBurst(0.0f),
+	RateLimitHitsPerSecond(0.0f),
+	bDropOverRateLimit(false),
+	bRateLimited(false),
+	LastRefillTime(FPlatformTime::Seconds()),
+	MaxQueuedBytes(0),
+	OverflowPolicy(EGoogleAnalyticsQueueOverflowPolicy::DropLowestPriority),
+	Transport(FAnalyticsGoogleAnalytics::Get().CreateTransport()),
+	NextBatchId(1),
+	MaxInFlightBatches(FMath::Max(GetDefault<UGoogleAnalyticsSettings>()->MaxConcurrentRequests, 1)),
+	ConsecutiveFailures(0),
+	RetryNotBefore(0.0)
+{
+	const UGoogleAnalyticsSettings* Settings = GetDefault<UGoogleAnalyticsSettings>();
+
+	PayloadPool.Reserve(MaxPooledPayloads);
+
+	switch (Settings->BatchCompression)
+	{
+	case EGoogleAnalyticsCompression::Deflate:
+		CompressionFlags = COMPRESS_ZLIB;
+		break;
+	case EGoogleAnalyticsCompression::Gzip:
+		CompressionFlags = COMPRESS_GZIP;
+		break;
+	default:
+		CompressionFlags = COMPRESS_None;
+		break;
+	}
+
+	CompressionThreshold = FMath::Max(Settings->CompressionThresholdBytes, 0);
+
+	RateLimitBurst = (float)FMath::Max(Settings->RateLimitBurst, 0);
+	RateLimitHitsPerSecond = FMath::Max(Settings->RateLimitHitsPerSecond, 0.01f);
+	RateLimitTokens = RateLimitBurst;
+	bDropOverRateLimit = Settings->RateLimitPolicy == EGoogleAnalyticsRateLimitPolicy::Drop;
+
+	MaxQueuedBytes = FMath::Max(Settings->MaxQueuedHitBytes, 0);
+	OverflowPolicy = Settings->QueueOverflowPolicy;
+}
+
+FGoogleAnalyticsDispatcher::~FGoogleAnalyticsDispatcher()
+{
+	// Persisted hits are delivered by the next run, only send what would otherwise be lost
+	if (!HitStore.IsOpen())
+	{
+		Dispatch();
+	}
+	else
+	{
+		// The HTTP module still delivers cancelled requests on shutdown, a batch that was already sent but is never
+		// acknowledged would be sent again by the next run
+		WaitForBatches(FPlatformTime::Seconds() + MaxShutdownWaitSeconds, true);
+	}
+
+	// Batches outlive the dispatcher, make sure they don't call back into it
+	Transport->CancelPendingBatches();
+
+	if (NumRateLimitDroppedHits.GetValue() > 0)
+	{
+		UE_LOG(LogGoogleAnalytics, Log, TEXT("Dropped %d hits over the rate limit"), NumRateLimitDroppedHits.GetValue());
+	}
+
+	if (NumRateLimitDeferredHits.GetValue() > 0)
+	{
+		UE_LOG(LogGoogleAnalytics, Log, TEXT("Held back %d hits for the rate limit"), NumRateLimitDeferredHits.GetValue());
+	}
+
+	if (NumOverflowedHits.GetValue() > 0)
+	{
+		UE_LOG(LogGoogleAnalytics, Log, TEXT("Dropped %d hits over the queue memory budget"), NumOverflowedHits.GetValue());
+	}
+}
+
+void FGoogleAnalyticsDispatcher::RestorePersistedHits()
+{
+	if (bRestoredPersistedHits)
+	{
+		return;
+	}
+	bRestoredPersistedHits = true;
+
+	TArray<FGoogleAnalyticsHit> PersistedHits;
+	FScopeLock ScopeLock(&Lock);
+	HitStore.Open(FPaths::ProjectSavedDir() / TEXT("GoogleAnalytics") / TEXT("PendingHits.log"), PersistedHits);
+
+	for (const FGoogleAnalyticsHit& Hit : PersistedHits)
+	{
+		NextHitId = FMath::Max(NextHitId, Hit.Id + 1);
+	}
+
+	if (PersistedHits.Num() > 0)
+	{
+		UE_LOG(LogGoogleAnalytics, Log, TEXT("Restored %d undelivered hits"), PersistedHits.Num());
+		RequeueHits(MoveTemp(PersistedHits));
+		EnforceMemoryBudget();
+		NumPendingHits.Set(GetNumQueuedHits() + RetryHits.Num());
+	}
+}
+
+TArray<uint8> FGoogleAnalyticsDispatcher::AcquirePayloadBuffer()
+{
+	FScopeLock ScopeLock(&PayloadPoolLock);
+
+	if (PayloadPool.Num() > 0)
+	{
+		TArray<uint8> Buffer = PayloadPool.Pop(false);
+		Buffer.Reset();
+		return Buffer;
+	}
+
+	return TArray<uint8>();
+}
+
+void FGoogleAnalyticsDispatcher::AcknowledgeBatch(const TArray<FGoogleAnalyticsHit>& Hits)
+{
+	TArray<uint64, TInlineAllocator<MaxHitsPerBatch>> HitIds;
+	for (const FGoogleAnalyticsHit& Hit : Hits)
+	{
+		HitIds.Add(Hit.Id);
+	}
+	HitStore.Acknowledge(HitIds);
+}
+
+void FGoogleAnalyticsDispatcher::RecyclePayloads(TArray<FGoogleAnalyticsHit>& Hits)
+{
+	FScopeLock ScopeLock(&PayloadPoolLock);
+
+	for (FGoogleAnalyticsHit& Hit : Hits)
+	{
+		if (PayloadPool.Num() >= MaxPooledPayloads)
+		{
+			break;
+		}
+		PayloadPool.Add(MoveTemp(Hit.Payload));
+	}
+}
+
+void FGoogleAnalyticsDispatcher::EnqueueHit(TArray<uint8>&& Payload, const int64 CaptureTime, const EGoogleAnalyticsHitPriority Priority)
+{
+	const int32 HitBytes = Payload.Num();
+	if (HitBytes > MaxHitBytes - QueueTimeReserveBytes)
+	{
+		UE_LOG(LogGoogleAnalytics, Warning, TEXT("Dropping hit larger than %d bytes"), MaxHitBytes);
+		return;
+	}
+
+	FGoogleAnalyticsHit Hit;
+	Hit.Id = NextHitId++;
+	Hit.CaptureTime = CaptureTime;
+	Hit.Payload = MoveTemp(Payload);
+	Hit.Priority = Priority;
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		HitStore.Append(Hit);
+	}
+
+	// Released summaries and coalesced hits carry the capture time of their first hit, everything else goes to the back
+	TArray<FGoogleAnalyticsHit>& LaneHits = PendingHits[(int32)Priority];
+	int32 InsertIndex = LaneHits.Num();
+	while (InsertIndex > 0 && LaneHits[InsertIndex - 1].CaptureTime > Hit.CaptureTime)
+	{
+		InsertIndex--;
+	}
+	LaneHits.Insert(MoveTemp(Hit), InsertIndex);
+
+	PendingBytes += HitBytes + 1;
+	NumPendingHits.Increment();
+
+	// Queued behind hits already waiting for tokens
+	if (bRateLimited)
+	{
+		NumRateLimitDeferredHits.Increment();
+	}
+
+	EnforceMemoryBudget();
+}
+
+void FGoogleAnalyticsDispatcher::Dispatch()
+{
+	if (IsBackingOff())
+	{
+		return;
+	}
+
+	const int64 Now = FDateTime::UtcNow().GetTicks();
+	RefillRateLimitTokens();
+
+	TArray<FGoogleAnalyticsHit> BodyHits;
+	BodyBuffer.Reset();
+
+	// Expired and rate limited hits, acknowledged together once the queue has been walked
+	TArray<uint64, TInlineAllocator<MaxHitsPerBatch>> DroppedHitIds;
+
+	// Hits from the front of each lane that were either added to a batch or dropped
+	int32 NumConsumedHits[NumGoogleAnalyticsHitPriorities] = {};
+	bool bOutOfTokens = false;
+	int32 Lane = NumGoogleAnalyticsHitPriorities - 1;
+
+	while (HasFreeRequestSlot())
+	{
+		// Higher priority lanes are drained first
+		while (Lane >= 0 && NumConsumedHits[Lane] >= PendingHits[Lane].Num())
+		{
+			Lane--;
+		}
+
+		if (Lane < 0)
+		{
+			break;
+		}
+
+		FGoogleAnalyticsHit& Hit = PendingHits[Lane][NumConsumedHits[Lane]];
+
+		const int32 QueueTime = (int32)FMath::Clamp<int64>((Now - Hit.CaptureTime) / ETimespan::TicksPerMillisecond, 0, MAX_int32);
+		if (QueueTime >= FGoogleAnalyticsHitStore::MaxQueueTimeSeconds * 1000)
+		{
+			// Google Analytics discards hits queued for too long, don't waste bandwidth on them
+			DroppedHitIds.Add(Hit.Id);
+			PendingBytes -= Hit.Payload.Num() + 1;
+			NumConsumedHits[Lane]++;
+			continue;
+		}
+
+		ANSICHAR QueueTimeParam[QueueTimeReserveBytes];
+		const int32 QueueTimeParamLength = FCStringAnsi::Snprintf(QueueTimeParam, QueueTimeReserveBytes, "&qt=%d\n", QueueTime);
+		const int32 HitBytes = Hit.Payload.Num() + QueueTimeParamLength;
+
+		if (BodyHits.Num() == MaxHitsPerBatch || BodyBuffer.Num() + HitBytes > MaxBatchBytes)
+		{
+			// Check for a free slot again before starting the next batch
+			SendBatch(MoveTemp(BodyHits));
+			BodyHits.Reset();
+			BodyBuffer.Reset();
+			continue;
+		}
+
+		if (RateLimitBurst > 0.0f)
+		{
+			if (RateLimitTokens < 1.0f)
+			{
+				if (!bDropOverRateLimit)
+				{
+					// The rest waits for the bucket to refill
+					bOutOfTokens = true;
+					break;
+				}
+
+				DroppedHitIds.Add(Hit.Id);
+				PendingBytes -= Hit.Payload.Num() + 1;
+				NumRateLimitDroppedHits.Increment();
+				NumConsumedHits[Lane]++;
+				continue;
+			}
+
+			RateLimitTokens -= 1.0f;
+		}
+
+		BodyBuffer.Append(Hit.Payload);
+		BodyBuffer.Append(reinterpret_cast<const uint8*>(QueueTimeParam), QueueTimeParamLength);
+		PendingBytes -= Hit.Payload.Num() + 1;
+		BodyHits.Add(MoveTemp(Hit));
+		NumConsumedHits[Lane]++;
+	}
+
+	if (BodyHits.Num() > 0)
+	{
+		SendBatch(MoveTemp(BodyHits));
+	}
+
+	// Whatever didn't get a request slot or a token waits in the queue for the next tick
+	for (int32 Index = 0; Index < NumGoogleAnalyticsHitPriorities; Index++)
+	{
+		PendingHits[Index].RemoveAt(0, NumConsumedHits[Index], false);
+	}
+
+	if (bOutOfTokens)
+	{
+		BeginRateLimitDeferral();
+	}
+	else
+	{
+		bRateLimited = false;
+	}
+
+	const int32 NumQueuedHits = GetNumQueuedHits();
+	{
+		FScopeLock ScopeLock(&Lock);
+		HitStore.Acknowledge(DroppedHitIds);
+		NumPendingHits.Set(NumQueuedHits + RetryHits.Num());
+	}
+
+	if (NumQueuedHits == 0)
+	{
+		PendingBytes = 0;
+		TimeSinceDispatch = 0.0f;
+		bFlushing = false;
+	}
+}
+
+void FGoogleAnalyticsDispatcher::Flush()
+{
+	bFlushing = true;
+
+	// Whatever is sent now could be delivered without ever being acknowledged, the hit log replays it next run instead
+	if (bShuttingDown && HitStore.IsOpen())
+	{
+		return;
+	}
+
+	Dispatch();
+}
+
+void FGoogleAnalyticsDispatcher::BeginShutdown()
+{
+	bShuttingDown = true;
+}
+
+void FGoogleAnalyticsDispatcher::Tick(float DeltaTime)
+{
+	TimeSinceDispatch += DeltaTime;
+
+	RequeueRetryHits();
+
+	const int32 NumQueuedHits = GetNumQueuedHits();
+	if (NumQueuedHits > 0)
+	{
+		// Send early once a full batch is waiting, there is no point in holding it any longer
+		const bool bBatchFull = NumQueuedHits >= MaxHitsPerBatch || PendingBytes >= MaxBatchBytes;
+		if (bFlushing || bBatchFull || TimeSinceDispatch >= Interval)
+		{
+			if (HasRateLimitTokensForBatch())
+			{
+				Dispatch();
+			}
+			else
+			{
+				BeginRateLimitDeferral();
+			}
+		}
+	}
+}
+
+void FGoogleAnalyticsDispatcher::RefillRateLimitTokens()
+{
+	const double Now = FPlatformTime::Seconds();
+	RateLimitTokens = FMath::Min(RateLimitTokens + (float)(Now - LastRefillTime) * RateLimitHitsPerSecond, RateLimitBurst);
+	LastRefillTime = Now;
+}
+
+void FGoogleAnalyticsDispatcher::BeginRateLimitDeferral()
+{
+	// Every hit queued now waits for tokens, hits queued later are counted as they arrive
+	if (!bRateLimited)
+	{
+		bRateLimited = true;
+		NumRateLimitDeferredHits.Add(GetNumQueuedHits());
+	}
+}
+
+bool FGoogleAnalyticsDispatcher::HasRateLimitTokensForBatch() const
+{
+	if (RateLimitBurst <= 0.0f || bDropOverRateLimit)
+	{
+		return true;
+	}
+
+	// Wait for a whole batch worth of tokens instead of trickling out single hit requests
+	const float Elapsed = (float)(FPlatformTime::Seconds() - LastRefillTime);
+	const float Tokens = FMath::Min(RateLimitTokens + Elapsed * RateLimitHitsPerSecond, RateLimitBurst);
+	return Tokens >= FMath::Min3((float)GetNumQueuedHits(), (float)MaxHitsPerBatch, RateLimitBurst);
+}
+
+bool FGoogleAnalyticsDispatcher::WaitForInFlightBatches(const double Deadline)
+{
+	return WaitForBatches(Deadline, false);
+}
+
+bool FGoogleAnalyticsDispatcher::WaitForBatches(const double Deadline, const bool bInFlightOnly)
+{
+	for (;;)
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (InFlightBatches.Num() == 0 && (bInFlightOnly || NumPendingHits.GetValue() == 0))
+			{
+				return true;
+			}
+		}
+
+		if (FPlatformTime::Seconds() >= Deadline)
+		{
+			return false;
+		}
+
+		Transport->Pump();
+		FPlatformProcess::Sleep(0.005f);
+	}
+}
+
+FGoogleAnalyticsDispatcher::EBatchResult FGoogleAnalyticsDispatcher::ClassifyResponse(const int32 ResponseCode)
+{
+	// Connection failures and timeouts never reached the collector
+	if (ResponseCode == 0)
+	{
+		return EBatchResult::Retry;
+	}
+
+	if (EHttpResponseCodes::IsOk(ResponseCode))
+	{
+		return EBatchResult::Delivered;
+	}
+
+	if (ResponseCode >= EHttpResponseCodes::ServerError || ResponseCode == EHttpResponseCodes::RequestTimeout || ResponseCode == EHttpResponseCodes::TooManyRequests)
+	{
+		return EBatchResult::Retry;
+	}
+
+	// Anything else will be rejected again, sending it once more would only waste bandwidth
+	return EBatchResult::Rejected;
+}
+
+bool FGoogleAnalyticsDispatcher::HasFreeRequestSlot()
+{
+	FScopeLock ScopeLock(&Lock);
+	return InFlightBatches.Num() < MaxInFlightBatches;
+}
+
+bool FGoogleAnalyticsDispatcher::IsBackingOff()
+{
+	FScopeLock ScopeLock(&Lock);
+	return FPlatformTime::Seconds() < RetryNotBefore;
+}
+
+void FGoogleAnalyticsDispatcher::RequeueRetryHits()
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (RetryHits.Num() > 0)
+	{
+		// Retried hits keep their id and payload, only qt is recomputed when they are sent again
+		RequeueHits(MoveTemp(RetryHits));
+		RetryHits.Reset();
+		EnforceMemoryBudget();
+	}
+}
+
+void FGoogleAnalyticsDispatcher::RequeueHits(TArray<FGoogleAnalyticsHit>&& Hits)
+{
+	TArray<FGoogleAnalyticsHit> LaneHits[NumGoogleAnalyticsHitPriorities];
+
+	for (FGoogleAnalyticsHit& Hit : Hits)
+	{
+		PendingBytes += Hit.Payload.Num() + 1;
+		LaneHits[(int32)Hit.Priority].Add(MoveTemp(Hit));
+	}
+
+	for (int32 Index = 0; Index < NumGoogleAnalyticsHitPriorities; Index++)
+	{
+		TArray<FGoogleAnalyticsHit>& Requeued = LaneHits[Index];
+		TArray<FGoogleAnalyticsHit>& Queued = PendingHits[Index];
+
+		if (Requeued.Num() == 0)
+		{
+			continue;
+		}
+
+		Requeued.StableSort([](const FGoogleAnalyticsHit& A, const FGoogleAnalyticsHit& B)
+		{
+			return A.CaptureTime < B.CaptureTime;
+		});
+
+		// Requeued hits are mostly older than the queued ones, but a retried batch can hold hits newer than a late released summary
+		TArray<FGoogleAnalyticsHit> Merged;
+		Merged.Reserve(Requeued.Num() + Queued.Num());
+
+		int32 RequeuedIndex = 0;
+		int32 QueuedIndex = 0;
+		while (RequeuedIndex < Requeued.Num() || QueuedIndex < Queued.Num())
+		{
+			const bool bTakeRequeued = QueuedIndex == Queued.Num() || (RequeuedIndex < Requeued.Num() && Requeued[RequeuedIndex].CaptureTime <= Queued[QueuedIndex].CaptureTime);
+			Merged.Add(MoveTemp(bTakeRequeued ? Requeued[RequeuedIndex++] : Queued[QueuedIndex++]));
+		}
+
+		Queued = MoveTemp(Merged);
+	}
+}
+
+void FGoogleAnalyticsDispatcher::EnforceMemoryBudget()
+{
+	if (MaxQueuedBytes <= 0 || PendingBytes <= MaxQueuedBytes)
+	{
+		return;
+	}
+
+	if (NumOverflowedHits.GetValue() == 0)
+	{
+		UE_LOG(LogGoogleAnalytics, Warning, TEXT("Queued hits went over the memory budget of %d bytes, dropping hits"), MaxQueuedBytes);
+	}
+
+	// Lanes are ordered by capture time, so victims come off the front or the back of a lane. Normal priority hits go first
+	// under every policy, high priority hits only once no normal hit is left
+	const bool bDropNewest = OverflowPolicy == EGoogleAnalyticsQueueOverflowPolicy::DropNewest;
+	int32 NumDroppedFromFront[NumGoogleAnalyticsHitPriorities] = {};
+	TArray<uint64, TInlineAllocator<MaxHitsPerBatch>> DroppedHitIds;
+
+	int32 Lane = 0;
+	while (PendingBytes > MaxQueuedBytes)
+	{
+		while (Lane < NumGoogleAnalyticsHitPriorities && NumDroppedFromFront[Lane] >= PendingHits[Lane].Num())
+		{
+			Lane++;
+		}
+
+		if (Lane == NumGoogleAnalyticsHitPriorities)
+		{
+			break;
+		}
+
+		TArray<FGoogleAnalyticsHit>& LaneHits = PendingHits[Lane];
+		const FGoogleAnalyticsHit& Victim = bDropNewest ? LaneHits.Last() : LaneHits[NumDroppedFromFront[Lane]];
+
+		DroppedHitIds.Add(Victim.Id);
+		PendingBytes -= Victim.Payload.Num() + 1;
+		NumOverflowedHits.Increment();
+
+		if (bDropNewest)
+		{
+			LaneHits.Pop(false);
+		}
+		else
+		{
+			NumDroppedFromFront[Lane]++;
+		}
+	}
+
+	for (int32 Index = 0; Index < NumGoogleAnalyticsHitPriorities; Index++)
+	{
+		PendingHits[Index].RemoveAt(0, NumDroppedFromFront[Index], false);
+	}
+
+	// Only the hit log and the retry list are shared, the queue itself belongs to the worker
+	FScopeLock ScopeLock(&Lock);
+	HitStore.Acknowledge(DroppedHitIds);
+	NumPendingHits.Set(GetNumQueuedHits() + RetryHits.Num());
+}
+
+int32 FGoogleAnalyticsDispatcher::GetNumQueuedHits() const
+{
+	int32 NumQueuedHits = 0;
+	for (const TArray<FGoogleAnalyticsHit>& LaneHits : PendingHits)
+	{
+		NumQueuedHits += LaneHits.Num();
+	}
+	return NumQueuedHits;
+}
+
+bool FGoogleAnalyticsDispatcher::CompressBody()
+{
+	if (CompressionFlags == COMPRESS_None || BodyBuffer.Num() < CompressionThreshold)
+	{
+		return false;
+	}
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(CompressionFlags, BodyBuffer.Num());
+	CompressedBuffer.SetNumUninitialized(CompressedSize, false);
+
+	if (!FCompression::CompressMemory(CompressionFlags, CompressedBuffer.GetData(), CompressedSize, BodyBuffer.GetData(), BodyBuffer.Num()))
+	{
+		UE_LOG(LogGoogleAnalytics, Warning, TEXT("Unable to compress batch of %d bytes, sending it uncompressed"), BodyBuffer.Num());
+		return false;
+	}
+
+	CompressedBuffer.SetNum(CompressedSize, false);
+
+	// Only worth it if the body actually got smaller
+	return CompressedSize < BodyBuffer.Num();
+}
+
+void FGoogleAnalyticsDispatcher::SendBatch(TArray<FGoogleAnalyticsHit>&& Hits)
+{
+	const bool bCompressed = CompressBody();
+	const TCHAR* ContentEncoding = bCompressed ? (CompressionFlags == COMPRESS_GZIP ? TEXT("gzip") : TEXT("deflate")) : nullptr;
+
+	// Register the batch first, transports are allowed to complete it before SendBatch returns
+	FScopeLock ScopeLock(&Lock);
+	const uint64 BatchId = NextBatchId++;
+	InFlightBatches.Add(FInFlightBatch(BatchId, MoveTemp(Hits)));
+
+	if (!Transport->SendBatch(bCompressed ? CompressedBuffer : BodyBuffer, ContentEncoding, FGoogleAnalyticsBatchComplete::CreateRaw(this, &FGoogleAnalyticsDispatcher::OnBatchComplete, BatchId)))
+	{
+		const int32 BatchIndex = InFlightBatches.IndexOfByPredicate([BatchId](const FInFlightBatch& Batch)
+		{
+			return Batch.Id == BatchId;
+		});
+
+		// A transport that completed the batch despite failing has already settled it
+		if (BatchIndex == INDEX_NONE)
+		{
+			return;
+		}
+
+		TArray<FGoogleAnalyticsHit> FailedHits = MoveTemp(InFlightBatches[BatchIndex].Hits);
+		InFlightBatches.RemoveAtSwap(BatchIndex);
+		ScheduleRetry(MoveTemp(FailedHits));
+	}
+}
+
+void FGoogleAnalyticsDispatcher::OnBatchComplete(int32 ResponseCode, uint64 BatchId)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	const int32 BatchIndex = InFlightBatches.IndexOfByPredicate([BatchId](const FInFlightBatch& Batch)
+	{
+		return Batch.Id == BatchId;
+	});
+
+	if (BatchIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	TArray<FGoogleAnalyticsHit> Hits = MoveTemp(InFlightBatches[BatchIndex].Hits);
+	InFlightBatches.RemoveAtSwap(BatchIndex);
+
+	switch (ClassifyResponse(ResponseCode))
+	{
+	case EBatchResult::Delivered:
+		ConsecutiveFailures = 0;
+		AcknowledgeBatch(Hits);
+		RecyclePayloads(Hits);
+		break;
+	case EBatchResult::Retry:
+		ScheduleRetry(MoveTemp(Hits));
+		break;
+	case EBatchResult::Rejected:
+		UE_LOG(LogGoogleAnalytics, Warning, TEXT("Batch of %d hits rejected with response code %d, dropping it"), Hits.Num(), ResponseCode);
+		AcknowledgeBatch(Hits);
+		RecyclePayloads(Hits);
+		break;
+	}
+}
+
+void FGoogleAnalyticsDispatcher::ScheduleRetry(TArray<FGoogleAnalyticsHit>&& Hits)
+{
+	// Exponential backoff with jitter, so clients coming back online don't retry in lockstep
+	const float MaxDelay = FMath::Min((float)InitialRetryDelaySeconds * FMath::Pow(2.0f, (float)FMath::Min(ConsecutiveFailures, 16)), (float)MaxRetryDelaySeconds);
+	const float Delay = FMath::FRandRange(0.5f, 1.0f) * MaxDelay;
+
+	ConsecutiveFailures++;
+	RetryNotBefore = FPlatformTime::Seconds() + Delay;
+
+	UE_LOG(LogGoogleAnalytics, Log, TEXT("Failed to deliver batch of %d hits, retrying in %.1f seconds"), Hits.Num(), Delay);
+
+	NumPendingHits.Add(Hits.Num());
+	RetryHits.Append(MoveTemp(Hits));
+}
@@ -0,0 +1,210 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/Compression.h"
+#include "GoogleAnalyticsHitStore.h"
+#include "GoogleAnalyticsTransport.h"
+#include "GoogleAnalyticsSettings.h"
+
+/**
+ * Packs queued Measurement Protocol hits into /batch requests (platforms without native SDK).
+ * Driven by the analytics worker, batches are handed to the transport configured for the module.
+ */
+class FGoogleAnalyticsDispatcher
+{
+public:
+	/** Measurement Protocol limits for the /batch endpoint */
+	static const int32 MaxHitsPerBatch = 20;
+	static const int32 MaxHitBytes = 8 * 1024;
+	static const int32 MaxBatchBytes = 16 * 1024;
+
+	/** Room kept in every hit for the queue time (qt) parameter appended at dispatch */
+	static const int32 QueueTimeReserveBytes = 16;
+
+	/** Payload buffers of delivered hits kept for reuse */
+	static const int32 MaxPooledPayloads = 64;
+
+	/** Backoff applied after a retryable failure, doubled on every consecutive failure */
+	static const int32 InitialRetryDelaySeconds = 2;
+	static const int32 MaxRetryDelaySeconds = 5 * 60;
+
+	/** How long teardown waits for batches already in flight, so their hits are acknowledged instead of replayed by the next run */
+	static const int32 MaxShutdownWaitSeconds = 2;
+
+	/** Hits are buffered for SendInterval seconds, or until a full batch is ready (0 sends every tick) */
+	FGoogleAnalyticsDispatcher(const int32 SendInterval);
+	~FGoogleAnalyticsDispatcher();
+
+	/** Opens the offline hit log and queues hits left undelivered by previous runs, only does work on the first call */
+	void RestorePersistedHits();
+
+	/** Empty buffer for the payload of the next hit, recycled from delivered hits when possible so queueing a hit doesn't allocate */
+	TArray<uint8> AcquirePayloadBuffer();
+
+	/** Queues a UTF-8 hit payload (query string without host and path) recorded at CaptureTime (UTC ticks) for the next batch */
+	void EnqueueHit(TArray<uint8>&& Payload, const int64 CaptureTime, const EGoogleAnalyticsHitPriority Priority);
+
+	/** Packs queued hits into batches and sends as many as the in-flight limit allows */
+	void Dispatch();
+
+	/** Keeps dispatching, regardless of the send interval, until everything queued so far has been sent */
+	void Flush();
+
+	/** Called before the final flush on teardown, from then on hits persisted in the hit log are left for the next run */
+	void BeginShutdown();
+
+	/** Sends queued hits once the send interval has elapsed or a full batch is waiting */
+	void Tick(float DeltaTime);
+
+	/** Waits until all queued hits are sent and completed or Deadline (FPlatformTime::Seconds) passes, returns false on timeout */
+	bool WaitForInFlightBatches(const double Deadline);
+
+	/** Hits dropped so far because queued hits went over the memory budget, safe to call from any thread */
+	int32 GetNumOverflowedHits() const
+	{
+		return NumOverflowedHits.GetValue();
+	}
+
+	/** Hits dropped so far because of the rate limit with the Drop policy, safe to call from any thread */
+	int32 GetNumRateLimitDroppedHits() const
+	{
+		return NumRateLimitDroppedHits.GetValue();
+	}
+
+	/** Hits held back so far to wait for rate limit tokens with the Queue policy, safe to call from any thread */
+	int32 GetNumRateLimitDeferredHits() const
+	{
+		return NumRateLimitDeferredHits.GetValue();
+	}
+
+private:
+	struct FInFlightBatch
+	{
+		uint64 Id;
+
+		/** Kept until the batch is acknowledged so failed hits can be sent again unchanged */
+		TArray<FGoogleAnalyticsHit> Hits;
+
+		FInFlightBatch(const uint64 InId, TArray<FGoogleAnalyticsHit>&& InHits)
+			: Id(InId)
+			, Hits(MoveTemp(InHits))
+		{
+		}
+	};
+
+	enum class EBatchResult : uint8
+	{
+		Delivered,
+		Retry,
+		Rejected
+	};
+
+	static EBatchResult ClassifyResponse(const int32 ResponseCode);
+
+	/** Waits for in-flight batches, and unless bInFlightOnly for queued hits as well, pumping the transport meanwhile */
+	bool WaitForBatches(const double Deadline, const bool bInFlightOnly);
+
+	bool HasFreeRequestSlot();
+	bool IsBackingOff();
+
+	/** Moves hits handed back by failed batches to the front of the queue */
+	void RequeueRetryHits();
+
+	/** Merges hits handed back or restored into their priority lane by capture time */
+	void RequeueHits(TArray<FGoogleAnalyticsHit>&& Hits);
+
+	int32 GetNumQueuedHits() const;
+
+	/** Drops hits according to the overflow policy until queued hits fit the memory budget */
+	void EnforceMemoryBudget();
+
+	/** Compresses BodyBuffer into CompressedBuffer, returns false if the batch is better sent as is */
+	bool CompressBody();
+
+	/** Adds the tokens earned since the last refill */
+	void RefillRateLimitTokens();
+
+	/** Whether enough tokens are available to send the next batch in one go */
+	bool HasRateLimitTokensForBatch() const;
+
+	/** Called when hits due for dispatch are held back for tokens, counts the hits that now have to wait */
+	void BeginRateLimitDeferral();
+
+	/** Sends the batch currently assembled in BodyBuffer */
+	void SendBatch(TArray<FGoogleAnalyticsHit>&& Hits);
+	void OnBatchComplete(int32 ResponseCode, uint64 BatchId);
+
+	/** Acknowledges a finished batch in the hit log with a single record, expects Lock to be held */
+	void AcknowledgeBatch(const TArray<FGoogleAnalyticsHit>& Hits);
+
+	/** Keeps the payload buffers of finished hits for AcquirePayloadBuffer */
+	void RecyclePayloads(TArray<FGoogleAnalyticsHit>& Hits);
+
+	/** Hands hits of a failed batch back to the worker and backs off, expects Lock to be held */
+	void ScheduleRetry(TArray<FGoogleAnalyticsHit>&& Hits);
+
+	// Only touched by the worker
+	/** Queued hits per priority lane, ordered by capture time */
+	TArray<FGoogleAnalyticsHit> PendingHits[NumGoogleAnalyticsHitPriorities];
+	int32 PendingBytes;
+	float Interval;
+	float TimeSinceDispatch;
+	bool bFlushing;
+	bool bShuttingDown;
+	bool bRestoredPersistedHits;
+	uint64 NextHitId;
+
+	/** Reused for assembling batch payloads */
+	TArray<uint8> BodyBuffer;
+	TArray<uint8> CompressedBuffer;
+
+	ECompressionFlags CompressionFlags;
+	int32 CompressionThreshold;
+
+	/** Token bucket matching the Measurement Protocol per client quota, every sent hit costs one token */
+	float RateLimitTokens;
+	float RateLimitBurst;
+	float RateLimitHitsPerSecond;
+	bool bDropOverRateLimit;
+	double LastRefillTime;
+
+	/** Set while due hits wait for tokens, until a dispatch gets through the queue without running out of them */
+	bool bRateLimited;
+
+	/** Hits dropped because of the rate limit */
+	FThreadSafeCounter NumRateLimitDroppedHits;
+
+	/** Hits held back by the rate limit, once per stretch of waiting for tokens */
+	FThreadSafeCounter NumRateLimitDeferredHits;
+
+	int32 MaxQueuedBytes;
+	EGoogleAnalyticsQueueOverflowPolicy OverflowPolicy;
+
+	/** Hits dropped because the queue went over its memory budget */
+	FThreadSafeCounter NumOverflowedHits;
+
+	/** Mirrors the number of queued hits plus RetryHits.Num() for waiting threads */
+	FThreadSafeCounter NumPendingHits;
+
+	TSharedRef<IGoogleAnalyticsTransport, ESPMode::ThreadSafe> Transport;
+
+	/** Filled by transport completion callbacks, drained by the worker */
+	FCriticalSection PayloadPoolLock;
+	TArray<TArray<uint8>> PayloadPool;
+
+	// Shared with transport completion callbacks
+	FCriticalSection Lock;
+	TArray<FInFlightBatch> InFlightBatches;
+	uint64 NextBatchId;
+	int32 MaxInFlightBatches;
+	TArray<FGoogleAnalyticsHit> RetryHits;
+	int32 ConsecutiveFailures;
+	double RetryNotBefore;
+	FGoogleAnalyticsHitStore HitStore;
+};
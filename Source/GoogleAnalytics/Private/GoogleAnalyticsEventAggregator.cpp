@@ -0,0 +1,64 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsEventAggregator.h"
+
+FGoogleAnalyticsEventAggregator::FGoogleAnalyticsEventAggregator(const TArray<FString>& InCategories, const float InIntervalSeconds, const int32 InCountMetricIndex) :
+	Categories(InCategories),
+	IntervalSeconds(FMath::Max(InIntervalSeconds, 0.0f)),
+	CountMetricIndex(InCountMetricIndex),
+	LastReleaseTime(FPlatformTime::Seconds())
+{
+}
+
+bool FGoogleAnalyticsEventAggregator::CanAggregate(const FGoogleAnalyticsHitRecord& Hit) const
+{
+	return Hit.Type == EGoogleAnalyticsHitType::Event && Categories.Num() > 0 && Categories.Contains(Hit.Text[0]);
+}
+
+void FGoogleAnalyticsEventAggregator::Add(FGoogleAnalyticsHitRecord&& Hit)
+{
+	FAggregateKey Key;
+	Key.Category = Hit.Text[0];
+	Key.Action = Hit.Text[1];
+	Key.Label = Hit.Text[2];
+
+	if (FAggregate* Aggregate = Aggregates.Find(Key))
+	{
+		Aggregate->Count++;
+		Aggregate->Hit.Number[0] += Hit.Number[0];
+		return;
+	}
+
+	FAggregate& Aggregate = Aggregates.Add(MoveTemp(Key));
+	Aggregate.Hit = MoveTemp(Hit);
+	Aggregate.Count = 1;
+}
+
+void FGoogleAnalyticsEventAggregator::Release(const bool bReleaseAll, TArray<FGoogleAnalyticsHitRecord>& OutHits)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (!bReleaseAll && Now - LastReleaseTime < IntervalSeconds)
+	{
+		return;
+	}
+	LastReleaseTime = Now;
+
+	for (TPair<FAggregateKey, FAggregate>& Pair : Aggregates)
+	{
+		FAggregate& Aggregate = Pair.Value;
+
+		if (CountMetricIndex > 0)
+		{
+			FCustomMetric CountMetric;
+			CountMetric.Index = CountMetricIndex;
+			CountMetric.Value = (float)Aggregate.Count;
+			Aggregate.Hit.CustomMetrics.Add(CountMetric);
+		}
+
+		OutHits.Add(MoveTemp(Aggregate.Hit));
+	}
+
+	Aggregates.Reset();
+}
@@ -0,0 +1,59 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GoogleAnalyticsHitRecord.h"
+
+/**
+ * Replaces events of aggregated categories with one summary event per category, action and label (platforms without native SDK).
+ * The summary carries the summed value and keeps the custom dimensions of the first event, the number of events
+ * is attached as a custom metric when one is configured.
+ */
+class FGoogleAnalyticsEventAggregator
+{
+public:
+	FGoogleAnalyticsEventAggregator(const TArray<FString>& Categories, const float InIntervalSeconds, const int32 InCountMetricIndex);
+
+	/** Whether the hit is an event of an aggregated category */
+	bool CanAggregate(const FGoogleAnalyticsHitRecord& Hit) const;
+
+	/** Adds the event to the counters of its key */
+	void Add(FGoogleAnalyticsHitRecord&& Hit);
+
+	/** Moves summary events to OutHits once the interval has elapsed, or right away if bReleaseAll is set */
+	void Release(const bool bReleaseAll, TArray<FGoogleAnalyticsHitRecord>& OutHits);
+
+private:
+	struct FAggregateKey
+	{
+		FString Category;
+		FString Action;
+		FString Label;
+
+		bool operator==(const FAggregateKey& Other) const
+		{
+			return Category.Equals(Other.Category, ESearchCase::CaseSensitive) && Action.Equals(Other.Action, ESearchCase::CaseSensitive) && Label.Equals(Other.Label, ESearchCase::CaseSensitive);
+		}
+
+		friend uint32 GetTypeHash(const FAggregateKey& Key)
+		{
+			return HashCombine(HashCombine(GetTypeHash(Key.Category), GetTypeHash(Key.Action)), GetTypeHash(Key.Label));
+		}
+	};
+
+	struct FAggregate
+	{
+		/** First event of the interval, turned into the summary */
+		FGoogleAnalyticsHitRecord Hit;
+		int32 Count;
+	};
+
+	TSet<FString> Categories;
+	double IntervalSeconds;
+	int32 CountMetricIndex;
+	double LastReleaseTime;
+	TMap<FAggregateKey, FAggregate> Aggregates;
+};
@@ -0,0 +1,102 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsEventAttributes.h"
+
+namespace GoogleAnalyticsEventAttributes
+{
+	struct FKnownName
+	{
+		const TCHAR* Name;
+		int32 Length;
+	};
+
+	/** Indexed by EGoogleAnalyticsAttribute, matched case-sensitively like the provider always did */
+	const FKnownName Names[] = {
+		{ TEXT("Category"), 8 },
+		{ TEXT("Label"), 5 },
+		{ TEXT("Value"), 5 },
+		{ TEXT("Currency"), 8 },
+		{ TEXT("PerItemCost"), 11 },
+		{ TEXT("RealCurrencyType"), 16 },
+		{ TEXT("RealMoneyCost"), 13 },
+		{ TEXT("PaymentProvider"), 15 }
+	};
+
+	static_assert((int32)ARRAY_COUNT(Names) == NumGoogleAnalyticsAttributes, "Every attribute needs a name");
+
+	const TCHAR CustomDimensionPrefix[] = TEXT("CustomDimension");
+	const TCHAR CustomMetricPrefix[] = TEXT("CustomMetric");
+}
+
+FGoogleAnalyticsEventAttributes::FGoogleAnalyticsEventAttributes(const TArray<FAnalyticsEventAttribute>& Attributes)
+	: MemMark(FMemStack::Get())
+{
+	using namespace GoogleAnalyticsEventAttributes;
+
+	for (const FAnalyticsEventAttribute& Attribute : Attributes)
+	{
+		const FString& Name = Attribute.AttrName;
+
+		const int32 DimensionIndex = ParseIndexedName(Name, CustomDimensionPrefix, ARRAY_COUNT(CustomDimensionPrefix) - 1);
+		if (DimensionIndex != INDEX_NONE)
+		{
+			FCustomDimension CustomDimension;
+			CustomDimension.Index = DimensionIndex;
+			CustomDimension.Value = Attribute.ToString();
+
+			if (CustomDimension.Value.Len() > 0)
+			{
+				CustomDimensions.Add(MoveTemp(CustomDimension));
+			}
+			continue;
+		}
+
+		const int32 MetricIndex = ParseIndexedName(Name, CustomMetricPrefix, ARRAY_COUNT(CustomMetricPrefix) - 1);
+		if (MetricIndex != INDEX_NONE)
+		{
+			const FString Value = Attribute.ToString();
+			if (Value.IsNumeric())
+			{
+				FCustomMetric CustomMetric;
+				CustomMetric.Index = MetricIndex;
+				CustomMetric.Value = FCString::Atof(*Value);
+				CustomMetrics.Add(CustomMetric);
+			}
+			continue;
+		}
+
+		// The length rules out all but one or two candidates before any characters are compared
+		const int32 NameLength = Name.Len();
+		for (int32 Index = 0; Index < NumGoogleAnalyticsAttributes; Index++)
+		{
+			if (Names[Index].Length == NameLength && FCString::Strcmp(*Name, Names[Index].Name) == 0)
+			{
+				Values[Index] = Attribute.ToString();
+				break;
+			}
+		}
+	}
+}
+
+int32 FGoogleAnalyticsEventAttributes::ParseIndexedName(const FString& Name, const TCHAR* Prefix, const int32 PrefixLength)
+{
+	if (Name.Len() <= PrefixLength || FCString::Strnicmp(*Name, Prefix, PrefixLength) != 0)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Index = 0;
+	for (const TCHAR* Char = *Name + PrefixLength; *Char; Char++)
+	{
+		// Indices are small, anything longer than a few digits is not a valid index either
+		if (!FChar::IsDigit(*Char) || Index > 100000)
+		{
+			return INDEX_NONE;
+		}
+		Index = Index * 10 + (*Char - TEXT('0'));
+	}
+
+	return Index;
+}
@@ -0,0 +1,77 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+#include "AnalyticsEventAttribute.h"
+#include "GoogleAnalyticsDelegates.h"
+
+/** Attribute names the provider maps to hit parameters */
+enum class EGoogleAnalyticsAttribute : uint8
+{
+	Category,
+	Label,
+	Value,
+	Currency,
+	PerItemCost,
+	RealCurrencyType,
+	RealMoneyCost,
+	PaymentProvider
+};
+
+static const int32 NumGoogleAnalyticsAttributes = (int32)EGoogleAnalyticsAttribute::PaymentProvider + 1;
+
+/**
+ * Sorts analytics event attributes into known fields, custom dimensions (CustomDimensionN) and custom metrics (CustomMetricN)
+ * in a single pass. Known names are matched by length first, the dimension and metric prefixes are matched ignoring case
+ * like they always were and their indices are parsed in place.
+ * The dimension and metric lists live on the calling thread's FMemStack, which is reset once the classifier goes out of scope,
+ * so it is meant to be used as a local while recording a hit.
+ */
+class FGoogleAnalyticsEventAttributes
+{
+public:
+	explicit FGoogleAnalyticsEventAttributes(const TArray<FAnalyticsEventAttribute>& Attributes);
+
+	/** Value of a known attribute, nullptr if it is missing or empty */
+	const FString* Find(const EGoogleAnalyticsAttribute Attribute) const
+	{
+		const FString& Value = Values[(int32)Attribute];
+		return Value.IsEmpty() ? nullptr : &Value;
+	}
+
+	FString GetString(const EGoogleAnalyticsAttribute Attribute, const TCHAR* Default) const
+	{
+		const FString* Value = Find(Attribute);
+		return Value ? *Value : FString(Default);
+	}
+
+	float GetFloat(const EGoogleAnalyticsAttribute Attribute) const
+	{
+		const FString* Value = Find(Attribute);
+		return Value ? FCString::Atof(**Value) : 0.0f;
+	}
+
+	int32 GetInt(const EGoogleAnalyticsAttribute Attribute) const
+	{
+		const FString* Value = Find(Attribute);
+		return Value ? FCString::Atoi(**Value) : 0;
+	}
+
+private:
+	/** Declared first, so the arena is popped only after the lists allocated from it are destroyed */
+	FMemMark MemMark;
+
+public:
+	TArray<FCustomDimension, TMemStackAllocator<>> CustomDimensions;
+	TArray<FCustomMetric, TMemStackAllocator<>> CustomMetrics;
+
+private:
+	/** Index parsed from the digits following Prefix in Name, INDEX_NONE if Name is not Prefix followed by digits only */
+	static int32 ParseIndexedName(const FString& Name, const TCHAR* Prefix, const int32 PrefixLength);
+
+	FString Values[NumGoogleAnalyticsAttributes];
+};
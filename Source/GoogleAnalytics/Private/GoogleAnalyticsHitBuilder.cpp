@@ -0,0 +1,251 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsHitBuilder.h"
+#include "GoogleAnalyticsDispatcher.h"
+#include "GoogleAnalyticsHitValidator.h"
+#include "GoogleAnalyticsUtf8.h"
+
+namespace GoogleAnalyticsHitBuilder
+{
+	const ANSICHAR HexDigits[] = "0123456789ABCDEF";
+
+	/** Same set of ASCII characters FPlatformHttp::UrlEncode leaves as they are: A-Z a-z 0-9 - _ . ~ */
+	struct FUnreservedTable
+	{
+		bool bUnreserved[128];
+
+		FUnreservedTable()
+		{
+			for (int32 Char = 0; Char < 128; Char++)
+			{
+				bUnreserved[Char] = (Char >= 'A' && Char <= 'Z') || (Char >= 'a' && Char <= 'z') || (Char >= '0' && Char <= '9') || Char == '-' || Char == '_' || Char == '.' || Char == '~';
+			}
+		}
+	};
+
+	const FUnreservedTable UnreservedTable;
+
+	/** Bits that are only set in a word of characters if one of them is outside ASCII */
+	const uint64 NonAsciiMask = sizeof(TCHAR) == 2 ? 0xFF80FF80FF80FF80ull : 0xFFFFFF80FFFFFF80ull;
+	const int32 CharsPerWord = sizeof(uint64) / sizeof(TCHAR);
+
+	/**
+	 * Most bytes a single TCHAR can produce once percent-encoded. With UTF-16 a surrogate pair is 4 UTF-8 bytes for two TCHARs and a BMP
+	 * character or a replaced lone surrogate 3, so 9. With 4 byte TCHAR a single character can be an astral code point of 4 UTF-8 bytes, so 12.
+	 */
+	const int32 MaxEncodedBytesPerChar = sizeof(TCHAR) == 4 ? 12 : 9;
+}
+
+FGoogleAnalyticsHitBuilder::FGoogleAnalyticsHitBuilder()
+{
+	Buffer.Reserve(FGoogleAnalyticsDispatcher::MaxHitBytes);
+}
+
+void FGoogleAnalyticsHitBuilder::Reset()
+{
+	Buffer.Reset();
+}
+
+void FGoogleAnalyticsHitBuilder::AppendParam(const ANSICHAR* Name, const FString& Value)
+{
+	AppendName(Name);
+	AppendEncoded(*Value, Value.Len());
+}
+
+void FGoogleAnalyticsHitBuilder::AppendParam(const ANSICHAR* Name, const int32 Value)
+{
+	AppendName(Name);
+	AppendInteger(Value);
+}
+
+void FGoogleAnalyticsHitBuilder::AppendParam(const ANSICHAR* Name, const double Value)
+{
+	AppendName(Name);
+	AppendDouble(Value);
+}
+
+void FGoogleAnalyticsHitBuilder::AppendHitFields(const FGoogleAnalyticsHitRecord& Hit)
+{
+	const FGoogleAnalyticsHitSchema& Schema = GetGoogleAnalyticsHitSchema(Hit.Type);
+	AppendFragment(Schema.Fragment);
+
+	for (int32 FieldIndex = 0; FieldIndex < Schema.NumFields; FieldIndex++)
+	{
+		const FGoogleAnalyticsHitField& Field = Schema.Fields[FieldIndex];
+		AppendName(Field.Name, Field.NameLength);
+
+		switch (Field.Type)
+		{
+		case EGoogleAnalyticsFieldType::Text:
+		{
+			// Oversized values are cut to the limit of this field, the validator already rejected them if that is the policy
+			const FString& Value = Hit.Text[Field.Slot];
+			AppendEncoded(*Value, Field.MaxBytes > 0 ? FGoogleAnalyticsHitValidator::GetUtf8PrefixLength(Value, Field.MaxBytes) : Value.Len());
+			break;
+		}
+		case EGoogleAnalyticsFieldType::Integer:
+			// Aggregated values can outgrow int32, casting those is undefined, so they are saturated instead
+			AppendInteger((int32)FMath::Clamp(Hit.Number[Field.Slot], (double)MIN_int32, (double)MAX_int32));
+			break;
+		case EGoogleAnalyticsFieldType::Decimal:
+			AppendDouble(Hit.Number[Field.Slot]);
+			break;
+		}
+	}
+}
+
+void FGoogleAnalyticsHitBuilder::AppendIndexedParam(const ANSICHAR* Prefix, const int32 Index, const FString& Value)
+{
+	ANSICHAR IndexedName[16];
+	FCStringAnsi::Snprintf(IndexedName, sizeof(IndexedName), "%s%d", Prefix, Index);
+	AppendParam(IndexedName, Value);
+}
+
+void FGoogleAnalyticsHitBuilder::AppendIndexedParam(const ANSICHAR* Prefix, const int32 Index, const double Value)
+{
+	ANSICHAR IndexedName[16];
+	FCStringAnsi::Snprintf(IndexedName, sizeof(IndexedName), "%s%d", Prefix, Index);
+	AppendParam(IndexedName, Value);
+}
+
+void FGoogleAnalyticsHitBuilder::AppendEncodedBytes(const TArray<uint8>& Bytes)
+{
+	if (Buffer.Num() > 0 && Bytes.Num() > 0)
+	{
+		Buffer.Add('&');
+	}
+	Buffer.Append(Bytes);
+}
+
+void FGoogleAnalyticsHitBuilder::AppendFragment(const FString& Fragment)
+{
+	AppendUtf8(Fragment);
+}
+
+void FGoogleAnalyticsHitBuilder::AppendFragment(const ANSICHAR* Fragment)
+{
+	AppendAnsi(Fragment, FCStringAnsi::Strlen(Fragment));
+}
+
+void FGoogleAnalyticsHitBuilder::AppendName(const ANSICHAR* Name)
+{
+	AppendName(Name, FCStringAnsi::Strlen(Name));
+}
+
+void FGoogleAnalyticsHitBuilder::AppendName(const ANSICHAR* Name, const int32 Length)
+{
+	if (Buffer.Num() > 0)
+	{
+		Buffer.Add('&');
+	}
+	AppendAnsi(Name, Length);
+	Buffer.Add('=');
+}
+
+void FGoogleAnalyticsHitBuilder::AppendInteger(const int32 Value)
+{
+	ANSICHAR Digits[16];
+	AppendAnsi(Digits, FCStringAnsi::Snprintf(Digits, sizeof(Digits), "%d", Value));
+}
+
+void FGoogleAnalyticsHitBuilder::AppendAnsi(const ANSICHAR* Value, const int32 Length)
+{
+	Buffer.Append(reinterpret_cast<const uint8*>(Value), Length);
+}
+
+void FGoogleAnalyticsHitBuilder::AppendUtf8(const FString& Value)
+{
+	const TCHAR* Chars = *Value;
+	const int32 Length = Value.Len();
+
+	for (int32 Index = 0; Index < Length; Index++)
+	{
+		uint8 Bytes[4];
+		const int32 NumBytes = GoogleAnalyticsUtf8::EncodeChar(GoogleAnalyticsUtf8::DecodeChar(Chars, Length, Index), Bytes);
+		Buffer.Append(Bytes, NumBytes);
+	}
+}
+
+void FGoogleAnalyticsHitBuilder::AppendEncoded(const TCHAR* Chars, const int32 Length)
+{
+	using namespace GoogleAnalyticsHitBuilder;
+
+	// Grow once for the worst case and write through a raw pointer, the unused tail is trimmed at the end
+	const int32 Start = Buffer.Num();
+	Buffer.SetNumUninitialized(Start + Length * MaxEncodedBytesPerChar, false);
+	uint8* Out = Buffer.GetData() + Start;
+
+	int32 Index = 0;
+	while (Index < Length)
+	{
+		// Whole words of ASCII characters skip the UTF-8 conversion
+		if (Index + CharsPerWord <= Length)
+		{
+			uint64 Word;
+			FMemory::Memcpy(&Word, Chars + Index, sizeof(Word));
+
+			if ((Word & NonAsciiMask) == 0)
+			{
+				for (int32 WordIndex = 0; WordIndex < CharsPerWord; WordIndex++)
+				{
+					const uint8 Char = (uint8)Chars[Index + WordIndex];
+					if (UnreservedTable.bUnreserved[Char])
+					{
+						*Out++ = Char;
+					}
+					else
+					{
+						*Out++ = '%';
+						*Out++ = HexDigits[Char >> 4];
+						*Out++ = HexDigits[Char & 0x0F];
+					}
+				}
+				Index += CharsPerWord;
+				continue;
+			}
+		}
+
+		uint8 Bytes[4];
+		const int32 NumBytes = GoogleAnalyticsUtf8::EncodeChar(GoogleAnalyticsUtf8::DecodeChar(Chars, Length, Index), Bytes);
+		Index++;
+
+		for (int32 ByteIndex = 0; ByteIndex < NumBytes; ByteIndex++)
+		{
+			const uint8 Byte = Bytes[ByteIndex];
+			if (Byte < 0x80 && UnreservedTable.bUnreserved[Byte])
+			{
+				*Out++ = Byte;
+			}
+			else
+			{
+				*Out++ = '%';
+				*Out++ = HexDigits[Byte >> 4];
+				*Out++ = HexDigits[Byte & 0x0F];
+			}
+		}
+	}
+
+	check(Out <= Buffer.GetData() + Buffer.Num());
+	Buffer.SetNum((int32)(Out - Buffer.GetData()), false);
+}
+
+void FGoogleAnalyticsHitBuilder::AppendDouble(const double Value)
+{
+	ANSICHAR Digits[64];
+	int32 Length = FCStringAnsi::Snprintf(Digits, sizeof(Digits), "%f", Value);
+
+	// Trim trailing zeros but keep one digit after the point, like FString::SanitizeFloat
+	const ANSICHAR* Point = FCStringAnsi::Strchr(Digits, '.');
+	if (Point != nullptr)
+	{
+		const int32 MinLength = (int32)(Point - Digits) + 2;
+		while (Length > MinLength && Digits[Length - 1] == '0')
+		{
+			Length--;
+		}
+	}
+
+	AppendAnsi(Digits, Length);
+}
@@ -0,0 +1,60 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GoogleAnalyticsHitSchema.h"
+
+/**
+ * Appends Measurement Protocol parameters straight into a reusable UTF-8 buffer (platforms without native SDK).
+ * The buffer is sized for the largest hit up front and kept across hits, so encoding a hit does not allocate.
+ */
+class FGoogleAnalyticsHitBuilder
+{
+public:
+	FGoogleAnalyticsHitBuilder();
+
+	/** Starts a new hit, keeping the buffer */
+	void Reset();
+
+	/** Appends Name=Value, percent-encoding the UTF-8 value */
+	void AppendParam(const ANSICHAR* Name, const FString& Value);
+
+	void AppendParam(const ANSICHAR* Name, const int32 Value);
+
+	/** Appends the value formatted like FString::SanitizeFloat */
+	void AppendParam(const ANSICHAR* Name, const double Value);
+
+	/** Appends the hit type and its parameters as described by the hit type schema */
+	void AppendHitFields(const FGoogleAnalyticsHitRecord& Hit);
+
+	/** Appends an indexed parameter such as cd3=Value */
+	void AppendIndexedParam(const ANSICHAR* Prefix, const int32 Index, const FString& Value);
+	void AppendIndexedParam(const ANSICHAR* Prefix, const int32 Index, const double Value);
+
+	/** Appends already encoded UTF-8 parameters, a leading '&' is added unless this is the start of the hit */
+	void AppendEncodedBytes(const TArray<uint8>& Bytes);
+
+	/** Appends an already encoded fragment of parameters, including its leading '&' */
+	void AppendFragment(const FString& Fragment);
+	void AppendFragment(const ANSICHAR* Fragment);
+
+	/** UTF-8 query string of the hit built so far */
+	const TArray<uint8>& GetPayload() const
+	{
+		return Buffer;
+	}
+
+private:
+	void AppendName(const ANSICHAR* Name);
+	void AppendName(const ANSICHAR* Name, const int32 Length);
+	void AppendInteger(const int32 Value);
+	void AppendAnsi(const ANSICHAR* Value, const int32 Length);
+	void AppendUtf8(const FString& Value);
+	void AppendEncoded(const TCHAR* Chars, const int32 Length);
+	void AppendDouble(const double Value);
+
+	TArray<uint8> Buffer;
+};
@@ -0,0 +1,103 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsHitCoalescer.h"
+
+FGoogleAnalyticsHitCoalescer::FGoogleAnalyticsHitCoalescer(const float WindowSeconds, const int32 InCountDimensionIndex) :
+	WindowTicks(FMath::Max<int64>((int64)(WindowSeconds * ETimespan::TicksPerSecond), 0)),
+	CountDimensionIndex(InCountDimensionIndex)
+{
+}
+
+bool FGoogleAnalyticsHitCoalescer::CanCoalesce(const FGoogleAnalyticsHitRecord& Hit) const
+{
+	return WindowTicks > 0 && (Hit.Type == EGoogleAnalyticsHitType::Event || Hit.Type == EGoogleAnalyticsHitType::Pageview);
+}
+
+void FGoogleAnalyticsHitCoalescer::Add(FGoogleAnalyticsHitRecord&& Hit)
+{
+	for (FCoalescedHit& Coalesced : Hits)
+	{
+		if (Hit.CaptureTime - Coalesced.Hit.CaptureTime < WindowTicks && Matches(Coalesced.Hit, Hit))
+		{
+			Coalesced.Count++;
+			Coalesced.Hit.Number[0] += Hit.Number[0];
+
+			for (const FCustomMetric& Metric : Hit.CustomMetrics)
+			{
+				FCustomMetric* CoalescedMetric = Coalesced.Hit.CustomMetrics.FindByPredicate([&Metric](const FCustomMetric& Other)
+				{
+					return Other.Index == Metric.Index;
+				});
+
+				if (CoalescedMetric != nullptr)
+				{
+					CoalescedMetric->Value += Metric.Value;
+				}
+				else
+				{
+					Coalesced.Hit.CustomMetrics.Add(Metric);
+				}
+			}
+			return;
+		}
+	}
+
+	FCoalescedHit& Coalesced = Hits[Hits.AddDefaulted()];
+	Coalesced.Hit = MoveTemp(Hit);
+	Coalesced.Count = 1;
+}
+
+void FGoogleAnalyticsHitCoalescer::Release(const bool bReleaseAll, TArray<FGoogleAnalyticsHitRecord>& OutHits)
+{
+	const int64 ExpiryTime = FDateTime::UtcNow().GetTicks() - WindowTicks;
+
+	int32 NumReleased = 0;
+	for (; NumReleased < Hits.Num(); NumReleased++)
+	{
+		FCoalescedHit& Coalesced = Hits[NumReleased];
+		if (!bReleaseAll && Coalesced.Hit.CaptureTime > ExpiryTime)
+		{
+			break;
+		}
+
+		if (Coalesced.Count > 1 && CountDimensionIndex > 0)
+		{
+			FCustomDimension CountDimension;
+			CountDimension.Index = CountDimensionIndex;
+			CountDimension.Value = FString::FromInt(Coalesced.Count);
+			Coalesced.Hit.CustomDimensions.Add(CountDimension);
+		}
+
+		OutHits.Add(MoveTemp(Coalesced.Hit));
+	}
+
+	Hits.RemoveAt(0, NumReleased, false);
+}
+
+bool FGoogleAnalyticsHitCoalescer::Matches(const FGoogleAnalyticsHitRecord& A, const FGoogleAnalyticsHitRecord& B)
+{
+	if (A.Type != B.Type || A.CustomDimensions.Num() != B.CustomDimensions.Num())
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < FGoogleAnalyticsHitRecord::NumTextFields; Index++)
+	{
+		if (!A.Text[Index].Equals(B.Text[Index], ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+	}
+
+	for (int32 Index = 0; Index < A.CustomDimensions.Num(); Index++)
+	{
+		if (A.CustomDimensions[Index].Index != B.CustomDimensions[Index].Index || !A.CustomDimensions[Index].Value.Equals(B.CustomDimensions[Index].Value, ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,44 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GoogleAnalyticsHitRecord.h"
+
+/**
+ * Merges repeated event and screen view hits recorded within a time window into a single hit (platforms without native SDK).
+ * Hits match when type, category, action, label and custom dimensions are equal. Event values and custom metrics are summed,
+ * the number of merged hits is attached as a custom dimension when one is configured.
+ */
+class FGoogleAnalyticsHitCoalescer
+{
+public:
+	FGoogleAnalyticsHitCoalescer(const float WindowSeconds, const int32 InCountDimensionIndex);
+
+	/** Whether the hit may be held back and merged with repeats */
+	bool CanCoalesce(const FGoogleAnalyticsHitRecord& Hit) const;
+
+	/** Holds the hit back, merging it into an earlier matching hit still inside its window */
+	void Add(FGoogleAnalyticsHitRecord&& Hit);
+
+	/** Moves hits whose window has elapsed, or all hits if bReleaseAll is set, to OutHits in recording order */
+	void Release(const bool bReleaseAll, TArray<FGoogleAnalyticsHitRecord>& OutHits);
+
+private:
+	struct FCoalescedHit
+	{
+		FGoogleAnalyticsHitRecord Hit;
+		int32 Count;
+	};
+
+	static bool Matches(const FGoogleAnalyticsHitRecord& A, const FGoogleAnalyticsHitRecord& B);
+
+	/** Window length in UTC ticks, 0 disables coalescing */
+	int64 WindowTicks;
+	int32 CountDimensionIndex;
+
+	/** Held back hits, oldest first */
+	TArray<FCoalescedHit> Hits;
+};
@@ -0,0 +1,92 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+#include "GoogleAnalyticsDelegates.h"
+
+enum class EGoogleAnalyticsHitType : uint8
+{
+	Event,
+	Pageview,
+	Social,
+	Timing,
+	Transaction,
+	Item,
+	Exception
+};
+
+static const int32 NumGoogleAnalyticsHitTypes = (int32)EGoogleAnalyticsHitType::Exception + 1;
+
+/** Dispatch order of queued hits, high priority hits are sent first, never sampled or merged and evicted last */
+enum class EGoogleAnalyticsHitPriority : uint8
+{
+	Normal,
+	High
+};
+
+static const int32 NumGoogleAnalyticsHitPriorities = (int32)EGoogleAnalyticsHitPriority::High + 1;
+
+/** Revenue and error reports are high priority, everything else is normal */
+inline EGoogleAnalyticsHitPriority GetGoogleAnalyticsHitPriority(const EGoogleAnalyticsHitType Type)
+{
+	switch (Type)
+	{
+	case EGoogleAnalyticsHitType::Transaction:
+	case EGoogleAnalyticsHitType::Item:
+	case EGoogleAnalyticsHitType::Exception:
+		return EGoogleAnalyticsHitPriority::High;
+	default:
+		return EGoogleAnalyticsHitPriority::Normal;
+	}
+}
+
+/**
+ * Hit captured on the recording thread and encoded later by the analytics worker.
+ * Text and Number slots hold the hit type specific parameters:
+ *   Event       - Text: category, action, label                 Number: value
+ *   Pageview    - Text: screen name
+ *   Social      - Text: network, action, target
+ *   Timing      - Text: category, name                          Number: time in ms
+ *   Transaction - Text: id, affiliation, currency               Number: revenue
+ *   Item        - Text: transaction id, name, category, currency Number: price, quantity
+ *   Exception   - Text: description
+ */
+struct FGoogleAnalyticsHitRecord
+{
+	static const int32 NumTextFields = 4;
+	static const int32 NumNumberFields = 2;
+
+	EGoogleAnalyticsHitType Type;
+
+	/** UTC ticks of the moment the hit was recorded */
+	int64 CaptureTime;
+
+	FString Text[NumTextFields];
+	double Number[NumNumberFields];
+
+	/** Inline storage covers the usual handful of custom definitions, so recording a hit doesn't allocate for them */
+	TArray<FCustomDimension, TInlineAllocator<4>> CustomDimensions;
+	TArray<FCustomMetric, TInlineAllocator<4>> CustomMetrics;
+
+	FGoogleAnalyticsHitRecord()
+		: Type(EGoogleAnalyticsHitType::Event)
+		, CaptureTime(0)
+	{
+		Number[0] = 0.0;
+		Number[1] = 0.0;
+	}
+
+	explicit FGoogleAnalyticsHitRecord(const EGoogleAnalyticsHitType InType, const TArrayView<const FCustomDimension> InCustomDimensions, const TArrayView<const FCustomMetric> InCustomMetrics)
+		: Type(InType)
+		, CaptureTime(FDateTime::UtcNow().GetTicks())
+	{
+		Number[0] = 0.0;
+		Number[1] = 0.0;
+		CustomDimensions.Append(InCustomDimensions.GetData(), InCustomDimensions.Num());
+		CustomMetrics.Append(InCustomMetrics.GetData(), InCustomMetrics.Num());
+	}
+};
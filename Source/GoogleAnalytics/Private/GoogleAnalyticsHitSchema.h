@@ -0,0 +1,161 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GoogleAnalyticsHitRecord.h"
+
+/** How a hit parameter value is read from its slot in FGoogleAnalyticsHitRecord */
+enum class EGoogleAnalyticsFieldType : uint8
+{
+	/** Text[Slot], percent-encoded */
+	Text,
+	/** Number[Slot] truncated to an integer, saturated to the int32 range */
+	Integer,
+	/** Number[Slot] as a decimal */
+	Decimal
+};
+
+/** Measurement Protocol parameter of a hit type */
+struct FGoogleAnalyticsHitField
+{
+	const ANSICHAR* Name;
+	int32 NameLength;
+	EGoogleAnalyticsFieldType Type;
+	int32 Slot;
+
+	/** UTF-8 byte limit of text values, 0 if unlimited */
+	int32 MaxBytes;
+
+	/** Hits with an empty required text value are discarded by Google Analytics */
+	bool bRequired;
+
+	template<int32 NameSize>
+	constexpr FGoogleAnalyticsHitField(const ANSICHAR(&InName)[NameSize], const EGoogleAnalyticsFieldType InType, const int32 InSlot, const int32 InMaxBytes = 0, const bool bInRequired = false)
+		: Name(InName)
+		, NameLength(NameSize - 1)
+		, Type(InType)
+		, Slot(InSlot)
+		, MaxBytes(InMaxBytes)
+		, bRequired(bInRequired)
+	{
+	}
+
+	constexpr bool IsValid() const
+	{
+		return NameLength > 0 && Slot >= 0 && Slot < (Type == EGoogleAnalyticsFieldType::Text ? FGoogleAnalyticsHitRecord::NumTextFields : FGoogleAnalyticsHitRecord::NumNumberFields);
+	}
+};
+
+/** Parameters of a hit type, the single description both validation and encoding are driven by */
+struct FGoogleAnalyticsHitSchema
+{
+	/** Encoded constant parameters, starting with the hit type */
+	const ANSICHAR* Fragment;
+	const FGoogleAnalyticsHitField* Fields;
+	int32 NumFields;
+
+	template<int32 InNumFields>
+	constexpr FGoogleAnalyticsHitSchema(const ANSICHAR* InFragment, const FGoogleAnalyticsHitField(&InFields)[InNumFields])
+		: Fragment(InFragment)
+		, Fields(InFields)
+		, NumFields(InNumFields)
+	{
+	}
+
+	constexpr bool IsValid() const
+	{
+		for (int32 Index = 0; Index < NumFields; Index++)
+		{
+			if (!Fields[Index].IsValid())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+namespace GoogleAnalyticsHitSchema
+{
+	typedef EGoogleAnalyticsFieldType EType;
+
+	constexpr FGoogleAnalyticsHitField EventFields[] = {
+		{ "ec", EType::Text, 0, 150, true },
+		{ "ea", EType::Text, 1, 500, true },
+		{ "el", EType::Text, 2, 500 },
+		{ "ev", EType::Integer, 0 }
+	};
+
+	constexpr FGoogleAnalyticsHitField PageviewFields[] = {
+		{ "dp", EType::Text, 0, 2048, true },
+		{ "dt", EType::Text, 0, 1500 }
+	};
+
+	constexpr FGoogleAnalyticsHitField SocialFields[] = {
+		{ "sn", EType::Text, 0, 50, true },
+		{ "sa", EType::Text, 1, 50, true },
+		{ "st", EType::Text, 2, 2048 }
+	};
+
+	constexpr FGoogleAnalyticsHitField TimingFields[] = {
+		{ "utc", EType::Text, 0, 150, true },
+		{ "utv", EType::Text, 1, 500 },
+		{ "utt", EType::Integer, 0 }
+	};
+
+	constexpr FGoogleAnalyticsHitField TransactionFields[] = {
+		{ "ti", EType::Text, 0, 500, true },
+		{ "ta", EType::Text, 1, 500 },
+		{ "tr", EType::Decimal, 0 },
+		{ "cu", EType::Text, 2, 10 }
+	};
+
+	constexpr FGoogleAnalyticsHitField ItemFields[] = {
+		{ "ti", EType::Text, 0, 500, true },
+		{ "in", EType::Text, 1, 500, true },
+		{ "ip", EType::Decimal, 0 },
+		{ "iq", EType::Integer, 1 },
+		{ "iv", EType::Text, 2, 500 },
+		{ "ic", EType::Text, 1, 500 },
+		{ "cu", EType::Text, 3, 10 }
+	};
+
+	constexpr FGoogleAnalyticsHitField ExceptionFields[] = {
+		{ "exd", EType::Text, 0, 150 }
+	};
+
+	/** Indexed by EGoogleAnalyticsHitType */
+	constexpr FGoogleAnalyticsHitSchema Schemas[] = {
+		{ "&t=event", EventFields },
+		{ "&t=pageview", PageviewFields },
+		{ "&t=social", SocialFields },
+		{ "&t=timing", TimingFields },
+		{ "&t=transaction&ts=0&tt=0", TransactionFields },
+		{ "&t=item", ItemFields },
+		{ "&t=exception&exf=0", ExceptionFields }
+	};
+
+	static_assert((int32)ARRAY_COUNT(Schemas) == NumGoogleAnalyticsHitTypes, "Every hit type needs a schema");
+
+	constexpr bool AreSchemasValid()
+	{
+		for (int32 Index = 0; Index < (int32)ARRAY_COUNT(Schemas); Index++)
+		{
+			if (!Schemas[Index].IsValid())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static_assert(AreSchemasValid(), "Hit schema field reads outside of the hit record slots");
+}
+
+inline const FGoogleAnalyticsHitSchema& GetGoogleAnalyticsHitSchema(const EGoogleAnalyticsHitType Type)
+{
+	return GoogleAnalyticsHitSchema::Schemas[(int32)Type];
+}
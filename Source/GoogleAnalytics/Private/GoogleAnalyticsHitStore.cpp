@@ -0,0 +1,241 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsHitStore.h"
+#include "GoogleAnalytics.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Async/MappedFileHandle.h"
+
+namespace GoogleAnalyticsHitStore
+{
+	/**
+	 * Record layout: type, hit id, then for hits the capture time, payload length and UTF-8 payload.
+	 * Acknowledgements of several hits store the number of ids in place of the hit id, followed by the ids.
+	 */
+	const uint8 RecordTypeHit = 'H';
+	const uint8 RecordTypeHighPriorityHit = 'P';
+	const uint8 RecordTypeAck = 'A';
+	const uint8 RecordTypeAckBatch = 'B';
+	const int32 RecordHeaderSize = sizeof(uint8) + sizeof(uint64);
+	const int32 HitHeaderSize = sizeof(int64) + sizeof(int32);
+
+	template<typename T>
+	void WriteValue(TArray<uint8>& Buffer, const T Value)
+	{
+		Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	template<typename T>
+	T ReadValue(const uint8* Data)
+	{
+		T Value;
+		FMemory::Memcpy(&Value, Data, sizeof(T));
+		return Value;
+	}
+}
+
+FGoogleAnalyticsHitStore::FGoogleAnalyticsHitStore() :
+	Writer(nullptr),
+	UnacknowledgedHits(0)
+{
+}
+
+FGoogleAnalyticsHitStore::~FGoogleAnalyticsHitStore()
+{
+	delete Writer;
+}
+
+bool FGoogleAnalyticsHitStore::Open(const FString& InFilename, TArray<FGoogleAnalyticsHit>& OutPendingHits)
+{
+	check(!IsOpen());
+
+	Filename = InFilename;
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(Filename));
+
+	Load(OutPendingHits);
+	Compact(OutPendingHits);
+
+	if (!IsOpen())
+	{
+		UE_LOG(LogGoogleAnalytics, Warning, TEXT("Unable to open hit log %s, offline hits will not be persisted"), *Filename);
+	}
+
+	return IsOpen();
+}
+
+void FGoogleAnalyticsHitStore::Append(const FGoogleAnalyticsHit& Hit)
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	using namespace GoogleAnalyticsHitStore;
+
+	RecordBuffer.Reset();
+	WriteValue(RecordBuffer, Hit.Priority == EGoogleAnalyticsHitPriority::High ? RecordTypeHighPriorityHit : RecordTypeHit);
+	WriteValue(RecordBuffer, Hit.Id);
+	WriteValue(RecordBuffer, Hit.CaptureTime);
+	WriteValue(RecordBuffer, Hit.Payload.Num());
+	RecordBuffer.Append(Hit.Payload);
+	WriteRecord();
+
+	UnacknowledgedHits++;
+}
+
+void FGoogleAnalyticsHitStore::Acknowledge(TArrayView<const uint64> HitIds)
+{
+	if (!IsOpen() || HitIds.Num() == 0)
+	{
+		return;
+	}
+
+	using namespace GoogleAnalyticsHitStore;
+
+	UnacknowledgedHits -= HitIds.Num();
+	if (UnacknowledgedHits <= 0)
+	{
+		// Nothing left to replay, start over instead of growing the log
+		OpenWriter(false);
+		UnacknowledgedHits = 0;
+		return;
+	}
+
+	RecordBuffer.Reset();
+	if (HitIds.Num() == 1)
+	{
+		WriteValue(RecordBuffer, RecordTypeAck);
+		WriteValue(RecordBuffer, HitIds[0]);
+	}
+	else
+	{
+		WriteValue(RecordBuffer, RecordTypeAckBatch);
+		WriteValue(RecordBuffer, (uint64)HitIds.Num());
+		RecordBuffer.Append(reinterpret_cast<const uint8*>(HitIds.GetData()), HitIds.Num() * sizeof(uint64));
+	}
+	WriteRecord();
+}
+
+void FGoogleAnalyticsHitStore::Load(TArray<FGoogleAnalyticsHit>& OutPendingHits)
+{
+	using namespace GoogleAnalyticsHitStore;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Filename) || PlatformFile.FileSize(*Filename) <= 0)
+	{
+		return;
+	}
+
+	// Prefer mapping the log, fall back to reading it on platforms without mapped file support
+	TUniquePtr<IMappedFileHandle> MappedHandle(PlatformFile.OpenMapped(*Filename));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedHandle.IsValid() ? MappedHandle->MapRegion() : nullptr);
+	TArray<uint8> FileData;
+
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+
+	if (MappedRegion.IsValid())
+	{
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(FileData, *Filename))
+	{
+		Data = FileData.GetData();
+		Size = FileData.Num();
+	}
+
+	const int64 ExpiryTime = (FDateTime::UtcNow() - FTimespan::FromSeconds(MaxQueueTimeSeconds)).GetTicks();
+	TSet<uint64> AcknowledgedIds;
+	int64 Offset = 0;
+
+	while (Offset + RecordHeaderSize <= Size)
+	{
+		const uint8 Type = ReadValue<uint8>(Data + Offset);
+		const uint64 Id = ReadValue<uint64>(Data + Offset + sizeof(uint8));
+		int64 RecordEnd = Offset + RecordHeaderSize;
+
+		if (Type == RecordTypeAck)
+		{
+			AcknowledgedIds.Add(Id);
+		}
+		else if (Type == RecordTypeAckBatch)
+		{
+			// A record torn by a crash ends the usable part of the log
+			if (Id > (uint64)(Size - RecordEnd) / sizeof(uint64))
+			{
+				break;
+			}
+
+			for (uint64 Index = 0; Index < Id; Index++)
+			{
+				AcknowledgedIds.Add(ReadValue<uint64>(Data + RecordEnd));
+				RecordEnd += sizeof(uint64);
+			}
+		}
+		else if ((Type == RecordTypeHit || Type == RecordTypeHighPriorityHit) && RecordEnd + HitHeaderSize <= Size)
+		{
+			const int64 CaptureTime = ReadValue<int64>(Data + RecordEnd);
+			const int32 PayloadLength = ReadValue<int32>(Data + RecordEnd + sizeof(int64));
+			RecordEnd += HitHeaderSize + PayloadLength;
+
+			// A record torn by a crash ends the usable part of the log
+			if (PayloadLength < 0 || RecordEnd > Size)
+			{
+				break;
+			}
+
+			if (CaptureTime > ExpiryTime)
+			{
+				FGoogleAnalyticsHit Hit;
+				Hit.Id = Id;
+				Hit.CaptureTime = CaptureTime;
+				Hit.Priority = Type == RecordTypeHighPriorityHit ? EGoogleAnalyticsHitPriority::High : EGoogleAnalyticsHitPriority::Normal;
+				Hit.Payload.Append(Data + RecordEnd - PayloadLength, PayloadLength);
+				OutPendingHits.Add(MoveTemp(Hit));
+			}
+		}
+		else
+		{
+			UE_LOG(LogGoogleAnalytics, Warning, TEXT("Hit log %s is corrupted at offset %lld, discarding the rest"), *Filename, Offset);
+			break;
+		}
+
+		Offset = RecordEnd;
+	}
+
+	OutPendingHits.RemoveAll([&AcknowledgedIds](const FGoogleAnalyticsHit& Hit)
+	{
+		return AcknowledgedIds.Contains(Hit.Id);
+	});
+}
+
+void FGoogleAnalyticsHitStore::Compact(const TArray<FGoogleAnalyticsHit>& PendingHits)
+{
+	// Rewrite the log with live hits only, dropping acknowledgements and expired entries
+	OpenWriter(false);
+	UnacknowledgedHits = 0;
+
+	for (const FGoogleAnalyticsHit& Hit : PendingHits)
+	{
+		Append(Hit);
+	}
+}
+
+void FGoogleAnalyticsHitStore::OpenWriter(const bool bAppend)
+{
+	delete Writer;
+	Writer = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Filename, bAppend);
+}
+
+void FGoogleAnalyticsHitStore::WriteRecord()
+{
+	// Records are written with a single call so a crash can at worst tear the last one
+	if (!Writer->Write(RecordBuffer.GetData(), RecordBuffer.Num()))
+	{
+		UE_LOG(LogGoogleAnalytics, Warning, TEXT("Unable to write to hit log %s"), *Filename);
+	}
+}
@@ -0,0 +1,76 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GoogleAnalyticsHitRecord.h"
+
+class IFileHandle;
+
+/** Measurement Protocol hit waiting to be delivered */
+struct FGoogleAnalyticsHit
+{
+	/** Unique within the hit log, used to acknowledge delivery */
+	uint64 Id;
+
+	/** UTC ticks of the moment the hit was recorded, used for the queue time (qt) parameter */
+	int64 CaptureTime;
+
+	/** UTF-8 hit query string without host and path */
+	TArray<uint8> Payload;
+
+	EGoogleAnalyticsHitPriority Priority;
+
+	FGoogleAnalyticsHit()
+		: Id(0)
+		, CaptureTime(0)
+		, Priority(EGoogleAnalyticsHitPriority::Normal)
+	{
+	}
+};
+
+/**
+ * Append-only on-disk log of undelivered hits, so hits survive network outages, crashes and restarts.
+ * Every recorded hit is appended, every delivered batch or set of expired hits is followed by a single acknowledgement record.
+ * The log is replayed through a memory mapping on open and compacted down to the hits still worth sending.
+ */
+class FGoogleAnalyticsHitStore
+{
+public:
+	/** Measurement Protocol drops hits queued for longer than 4 hours */
+	static const int64 MaxQueueTimeSeconds = 4 * 60 * 60;
+
+	FGoogleAnalyticsHitStore();
+	~FGoogleAnalyticsHitStore();
+
+	/** Opens the log for appending, returning the unacknowledged hits that have not expired yet */
+	bool Open(const FString& InFilename, TArray<FGoogleAnalyticsHit>& OutPendingHits);
+
+	bool IsOpen() const
+	{
+		return Writer != nullptr;
+	}
+
+	/** Persists a newly recorded hit */
+	void Append(const FGoogleAnalyticsHit& Hit);
+
+	/** Marks hits as delivered (or expired) so they are not replayed, with one write for all of them */
+	void Acknowledge(TArrayView<const uint64> HitIds);
+
+private:
+	void Load(TArray<FGoogleAnalyticsHit>& OutPendingHits);
+	void Compact(const TArray<FGoogleAnalyticsHit>& PendingHits);
+	void OpenWriter(const bool bAppend);
+	void WriteRecord();
+
+	FString Filename;
+	IFileHandle* Writer;
+
+	/** Appended hits not acknowledged yet, the log is truncated once this drops to zero */
+	int32 UnacknowledgedHits;
+
+	/** Reused for serializing records, so appends don't allocate in steady state */
+	TArray<uint8> RecordBuffer;
+};
@@ -0,0 +1,146 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsHitValidator.h"
+#include "GoogleAnalytics.h"
+#include "GoogleAnalyticsHitSchema.h"
+#include "GoogleAnalyticsUtf8.h"
+
+FGoogleAnalyticsHitValidator::FGoogleAnalyticsHitValidator(const EGoogleAnalyticsValidationPolicy InPolicy, const bool bInReportViolations) :
+	Policy(InPolicy),
+	bReportViolations(bInReportViolations)
+{
+}
+
+bool FGoogleAnalyticsHitValidator::Validate(FGoogleAnalyticsHitRecord& Hit) const
+{
+	const FGoogleAnalyticsHitSchema& Schema = GetGoogleAnalyticsHitSchema(Hit.Type);
+	for (int32 FieldIndex = 0; FieldIndex < Schema.NumFields; FieldIndex++)
+	{
+		const FGoogleAnalyticsHitField& Field = Schema.Fields[FieldIndex];
+		if (Field.Type != EGoogleAnalyticsFieldType::Text)
+		{
+			continue;
+		}
+
+		FString& Value = Hit.Text[Field.Slot];
+		if (Field.bRequired && Value.IsEmpty())
+		{
+			if (bReportViolations)
+			{
+				UE_LOG(LogGoogleAnalytics, Warning, TEXT("Hit parameter %s is required but empty, rejecting the hit"), ANSI_TO_TCHAR(Field.Name));
+			}
+			else
+			{
+				UE_LOG(LogGoogleAnalytics, Verbose, TEXT("Hit parameter %s is required but empty"), ANSI_TO_TCHAR(Field.Name));
+			}
+			return false;
+		}
+
+		// Fields can share a slot with different limits (dp and dt), so the encoder truncates each one to its own limit
+		if (Field.MaxBytes > 0 && !ValidateField(Value, Field.Name, INDEX_NONE, Field.MaxBytes, false))
+		{
+			return false;
+		}
+	}
+
+	for (FCustomDimension& CustomDimension : Hit.CustomDimensions)
+	{
+		if (!ValidateField(CustomDimension.Value, "cd", CustomDimension.Index, MaxCustomDimensionBytes, true))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FGoogleAnalyticsHitValidator::ValidateField(FString& Value, const ANSICHAR* Parameter, const int32 ParameterIndex, const int32 MaxBytes, const bool bTruncateInPlace) const
+{
+	// Cheap check first, a field can't take more than 4 bytes per character
+	if (Value.Len() * 4 <= MaxBytes)
+	{
+		return true;
+	}
+
+	const int32 Length = GetUtf8Length(Value);
+	if (Length <= MaxBytes)
+	{
+		return true;
+	}
+
+	const bool bReject = Policy == EGoogleAnalyticsValidationPolicy::Reject;
+	const FString ParameterName = ParameterIndex != INDEX_NONE ? FString::Printf(TEXT("%s%d"), ANSI_TO_TCHAR(Parameter), ParameterIndex) : FString(ANSI_TO_TCHAR(Parameter));
+
+	if (bReportViolations)
+	{
+		UE_LOG(LogGoogleAnalytics, Warning, TEXT("Hit parameter %s is %d bytes long, the limit is %d bytes, %s: %s"), *ParameterName, Length, MaxBytes, bReject ? TEXT("rejecting the hit") : TEXT("truncating it"), *Value);
+	}
+	else
+	{
+		UE_LOG(LogGoogleAnalytics, Verbose, TEXT("Hit parameter %s is %d bytes long, the limit is %d bytes"), *ParameterName, Length, MaxBytes);
+	}
+
+	if (bReject)
+	{
+		return false;
+	}
+
+	if (bTruncateInPlace)
+	{
+		TruncateToUtf8Length(Value, MaxBytes);
+	}
+	return true;
+}
+
+int32 FGoogleAnalyticsHitValidator::GetUtf8Length(const FString& Value)
+{
+	const TCHAR* Chars = *Value;
+	const int32 NumChars = Value.Len();
+
+	int32 Length = 0;
+	for (int32 Index = 0; Index < NumChars; Index++)
+	{
+		Length += GoogleAnalyticsUtf8::GetEncodedLength(GoogleAnalyticsUtf8::DecodeChar(Chars, NumChars, Index));
+	}
+	return Length;
+}
+
+int32 FGoogleAnalyticsHitValidator::GetUtf8PrefixLength(const FString& Value, const int32 MaxBytes)
+{
+	// No character takes more than 4 bytes
+	if (Value.Len() * 4 <= MaxBytes)
+	{
+		return Value.Len();
+	}
+
+	const TCHAR* Chars = *Value;
+	const int32 NumChars = Value.Len();
+
+	int32 Length = 0;
+	int32 Index = 0;
+
+	while (Index < NumChars)
+	{
+		// Decoded the way the hit builder encodes, so a pair counts as 4 bytes and anything it replaces as the 3 byte U+FFFD
+		int32 NextIndex = Index;
+		const int32 CharLength = GoogleAnalyticsUtf8::GetEncodedLength(GoogleAnalyticsUtf8::DecodeChar(Chars, NumChars, NextIndex));
+
+		if (Length + CharLength > MaxBytes)
+		{
+			break;
+		}
+
+		Length += CharLength;
+		Index = NextIndex + 1;
+	}
+
+	return Index;
+}
+
+void FGoogleAnalyticsHitValidator::TruncateToUtf8Length(FString& Value, const int32 MaxBytes)
+{
+	const int32 NumChars = GetUtf8PrefixLength(Value, MaxBytes);
+	Value.RemoveAt(NumChars, Value.Len() - NumChars, false);
+}
@@ -0,0 +1,44 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GoogleAnalyticsHitRecord.h"
+#include "GoogleAnalyticsSettings.h"
+
+/**
+ * Enforces the Measurement Protocol field limits of the hit type schema before a hit is encoded (platforms without native SDK).
+ * Oversized fields are truncated or the whole hit is rejected, so hits Google Analytics would discard are never sent.
+ */
+class FGoogleAnalyticsHitValidator
+{
+public:
+	/** Custom dimension values are limited to 150 bytes */
+	static const int32 MaxCustomDimensionBytes = 150;
+
+	FGoogleAnalyticsHitValidator(const EGoogleAnalyticsValidationPolicy InPolicy, const bool bInReportViolations);
+
+	/** Truncates oversized custom dimensions in place, returns false if the hit has to be rejected or misses a required field */
+	bool Validate(FGoogleAnalyticsHitRecord& Hit) const;
+
+	/** Number of UTF-8 bytes needed to encode the string */
+	static int32 GetUtf8Length(const FString& Value);
+
+	/** Number of leading characters of the string that fit in MaxBytes UTF-8 bytes without splitting a character */
+	static int32 GetUtf8PrefixLength(const FString& Value, const int32 MaxBytes);
+
+	/** Shortens the string to at most MaxBytes UTF-8 bytes without splitting a character */
+	static void TruncateToUtf8Length(FString& Value, const int32 MaxBytes);
+
+private:
+	/**
+	 * Returns false if the field is too long and the hit is rejected, ParameterIndex is appended to the name of indexed parameters.
+	 * Oversized values are only truncated here with bTruncateInPlace, hit type fields are truncated by the encoder instead.
+	 */
+	bool ValidateField(FString& Value, const ANSICHAR* Parameter, const int32 ParameterIndex, const int32 MaxBytes, const bool bTruncateInPlace) const;
+
+	EGoogleAnalyticsValidationPolicy Policy;
+	bool bReportViolations;
+};
@@ -8,10 +8,16 @@
 #include "IAnalyticsProvider.h"
 #include "Analytics.h"
 #include "GoogleAnalyticsDelegates.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "GoogleAnalyticsHitRecord.h"
 
 #if !PLATFORM_IOS && !PLATFORM_ANDROID
 #include "Http.h" 
 #include "Json.h"
+#include "GoogleAnalyticsWorker.h"
+
+class FViewport;
 #endif
 
 #if PLATFORM_IOS && WITH_GOOGLEANALYTICS
@@ -24,16 +30,42 @@ class FAnalyticsProviderGoogleAnalytics :
 	public IAnalyticsProvider
 {
 	FString ApiTrackingId;
-	bool bHasSessionStarted;
-	bool bSessionStartedSent;
+	FThreadSafeBool bHasSessionStarted;
 	bool bAnonymizeIp;
 	FString UserId;
 	FString UniversalCid;
-	FString Location;
 	int32 Interval;
 	FString OpenUrlIOS;
 	FString OpenUrlHostIOS;
 
+#if !PLATFORM_IOS && !PLATFORM_ANDROID
+	/** Encodes and sends hits off the recording threads */
+	TUniquePtr<FGoogleAnalyticsWorker> Worker;
+
+	/** Guards UserId, which may be set and read from any thread */
+	mutable FCriticalSection UserIdLock;
+
+	/** System info last handed to the worker, game thread only */
+	FString LastSystemInfo;
+
+	FDelegateHandle ViewportResizedHandle;
+	FDelegateHandle CultureChangedHandle;
+
+	/**
+	 * Bit per EGoogleAnalyticsHitType set if this client sends that hit type, decided once per session from the client id.
+	 * Published with a single atomic store, as recording threads read it while a new session may be starting.
+	 */
+	FThreadSafeCounter SampledHitTypes;
+
+	/** Hands the current system info to the worker if it changed, called on session start, viewport resize and culture change */
+	void RefreshSystemInfo();
+	void OnViewportResized(FViewport* Viewport, uint32 Unused);
+	void UpdateSampling();
+#endif
+
+	/** Returns false for hit types this client drops because of sampling, checked before a hit is built */
+	bool IsSampledIn(const EGoogleAnalyticsHitType Type) const;
+
 	static TSharedPtr<IAnalyticsProvider> Provider;
 	FAnalyticsProviderGoogleAnalytics(const FString TrackingId, const int32 SendInterval);
 
@@ -62,6 +94,18 @@ public:
 	virtual void EndSession() override;
 	virtual void FlushEvents() override;
 
+	/** Flushes pending events and waits up to TimeoutSeconds for them to be sent (desktop only, mobile SDKs dispatch asynchronously) */
+	bool FlushEventsAndWait(const float TimeoutSeconds);
+
+	/** Hits dropped because queued hits went over the memory budget (desktop only, 0 with the mobile SDKs) */
+	int32 GetNumOverflowedHits() const;
+
+	/** Hits dropped over the rate limit with the Drop policy (desktop only, 0 with the mobile SDKs) */
+	int32 GetNumRateLimitDroppedHits() const;
+
+	/** Hits held back until rate limit tokens were available with the Queue policy (desktop only, 0 with the mobile SDKs) */
+	int32 GetNumRateLimitDeferredHits() const;
+
 	virtual void SetUserID(const FString& InUserID) override;
 	virtual FString GetUserID() const override;
 
@@ -73,9 +117,13 @@ public:
 	virtual void SetAge(const int32 InAge) override;
 
 	virtual void RecordEvent(const FString& EventName, const TArray<FAnalyticsEventAttribute>& Attributes) override;
-	void RecordScreen(const FString& ScreenName, const TArray<FCustomDimension> CustomDimensions = TArray<FCustomDimension>(), const TArray<FCustomMetric> CustomMetrics = TArray<FCustomMetric>());
-	void RecordSocialInteraction(const FString& Network, const FString& Action, const FString& Target, const TArray<FCustomDimension> CustomDimensions = TArray<FCustomDimension>(), const TArray<FCustomMetric> CustomMetrics = TArray<FCustomMetric>());
-	void RecordUserTiming(const FString& Category, const int32 Value, const FString& Name, const TArray<FCustomDimension> CustomDimensions = TArray<FCustomDimension>(), const TArray<FCustomMetric> CustomMetrics = TArray<FCustomMetric>());
+
+	/** Records an event from typed values, without going through analytics event attributes. An empty category is reported as the default category, custom dimensions with empty values are skipped */
+	void RecordEvent(const FString& Category, const FString& Action, const FString& Label, const float Value, const TArrayView<const FCustomDimension> CustomDimensions = TArrayView<const FCustomDimension>(), const TArrayView<const FCustomMetric> CustomMetrics = TArrayView<const FCustomMetric>());
+
+	void RecordScreen(const FString& ScreenName, const TArrayView<const FCustomDimension> CustomDimensions = TArrayView<const FCustomDimension>(), const TArrayView<const FCustomMetric> CustomMetrics = TArrayView<const FCustomMetric>());
+	void RecordSocialInteraction(const FString& Network, const FString& Action, const FString& Target, const TArrayView<const FCustomDimension> CustomDimensions = TArrayView<const FCustomDimension>(), const TArrayView<const FCustomMetric> CustomMetrics = TArrayView<const FCustomMetric>());
+	void RecordUserTiming(const FString& Category, const int32 Value, const FString& Name, const TArrayView<const FCustomDimension> CustomDimensions = TArrayView<const FCustomDimension>(), const TArrayView<const FCustomMetric> CustomMetrics = TArrayView<const FCustomMetric>());
 	virtual void RecordItemPurchase(const FString& ItemId, int ItemQuantity, const TArray<FAnalyticsEventAttribute>& EventAttrs) override;
 	virtual void RecordCurrencyPurchase(const FString& GameCurrencyType, int GameCurrencyAmount, const TArray<FAnalyticsEventAttribute>& EventAttrs) override;
 	virtual void RecordCurrencyGiven(const FString& GameCurrencyType, int GameCurrencyAmount, const TArray<FAnalyticsEventAttribute>& EventAttrs) override;
@@ -88,6 +136,9 @@ public:
 	void SetAnonymizeIp(const bool Anonymize);
 
 	FString GetSystemInfo();
+
+	/** Platform reported in the ua parameter */
+	static FString GetUserAgent();
 	
 	void SetOpenUrlIOS(const FString& OpenUrl);
 	FString GetOpenUrlIOS();
@@ -96,12 +147,6 @@ public:
 	FString GetOpenUrlHostIOS();
 
 #if PLATFORM_IOS && WITH_GOOGLEANALYTICS
-	id<GAITracker> BuildCustomDimensionsAndMetrics(id<GAITracker> tracker, const TArray<FCustomDimension> CustomDimensions, const TArray<FCustomMetric> CustomMetrics);
+	id<GAITracker> BuildCustomDimensionsAndMetrics(id<GAITracker> tracker, const TArrayView<const FCustomDimension> CustomDimensions, const TArrayView<const FCustomMetric> CustomMetrics);
 #endif
-
-	FString BuildCustomDimensions(const TArray<FCustomDimension> CustomDimensions);
-	FString BuildCustomMetrics(const TArray<FCustomMetric> CustomMetrics);
-
-	const TArray<FCustomDimension> BuildCustomDimensionsFromAttributes(const TArray<FAnalyticsEventAttribute>& Attributes);
-	const TArray<FCustomMetric> BuildCustomMetricsFromAttributes(const TArray<FAnalyticsEventAttribute>& Attributes);
 };
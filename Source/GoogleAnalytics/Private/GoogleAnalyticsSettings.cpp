@@ -7,5 +7,26 @@
 UGoogleAnalyticsSettings::UGoogleAnalyticsSettings(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, bEnableIDFACollection(true)
+	, MaxConcurrentRequests(2)
+	, MaxQueuedHitBytes(1024 * 1024)
+	, QueueOverflowPolicy(EGoogleAnalyticsQueueOverflowPolicy::DropLowestPriority)
+	, ValidationPolicy(EGoogleAnalyticsValidationPolicy::Truncate)
+	, bReportValidationErrors(false)
+	, Transport(EGoogleAnalyticsTransport::Http)
+	, CollectorUrl(TEXT("https://www.google-analytics.com/batch"))
+	, TransportFilename(TEXT("GoogleAnalytics/Batches.txt"))
+	, RateLimitBurst(20)
+	, RateLimitHitsPerSecond(2.0f)
+	, RateLimitPolicy(EGoogleAnalyticsRateLimitPolicy::Queue)
+	, AggregationIntervalSeconds(60.0f)
+	, AggregationCountMetricIndex(0)
+	, CoalesceWindowSeconds(0.0f)
+	, CoalesceCountDimensionIndex(0)
+	, EventSampleRate(100.0f)
+	, PageviewSampleRate(100.0f)
+	, SocialSampleRate(100.0f)
+	, TimingSampleRate(100.0f)
+	, BatchCompression(EGoogleAnalyticsCompression::None)
+	, CompressionThresholdBytes(1024)
 {
 }
@@ -0,0 +1,145 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsTransport.h"
+#include "GoogleAnalytics.h"
+#include "Http.h"
+#include "HttpManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Paths.h"
+
+FGoogleAnalyticsHttpTransport::FGoogleAnalyticsHttpTransport(const FString& InUrl) :
+	Url(InUrl)
+{
+}
+
+FGoogleAnalyticsHttpTransport::~FGoogleAnalyticsHttpTransport()
+{
+	CancelPendingBatches();
+}
+
+bool FGoogleAnalyticsHttpTransport::SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete)
+{
+	TSharedRef<IHttpRequest> HttpRequest = FHttpModule::Get().CreateRequest();
+	HttpRequest->SetURL(Url);
+	HttpRequest->SetVerb("POST");
+	HttpRequest->SetHeader("Content-Type", "text/plain");
+	if (ContentEncoding != nullptr)
+	{
+		HttpRequest->SetHeader("Content-Encoding", ContentEncoding);
+	}
+	HttpRequest->SetContent(Body);
+	HttpRequest->OnProcessRequestComplete().BindRaw(this, &FGoogleAnalyticsHttpTransport::OnRequestComplete, OnComplete);
+
+	// Hold the lock across ProcessRequest so the completion can't look for the request before it is registered.
+	// A request that fails to start completes synchronously on this thread before it is registered, that completion
+	// is ignored by OnRequestComplete since the caller is told about the failure through the return value instead
+	FScopeLock ScopeLock(&Lock);
+	if (!HttpRequest->ProcessRequest())
+	{
+		HttpRequest->OnProcessRequestComplete().Unbind();
+		return false;
+	}
+
+	PendingRequests.Add(HttpRequest);
+	return true;
+}
+
+void FGoogleAnalyticsHttpTransport::CancelPendingBatches()
+{
+	// Requests outlive their owner, make sure they don't call back into it
+	FScopeLock ScopeLock(&Lock);
+	for (const TSharedRef<IHttpRequest>& Request : PendingRequests)
+	{
+		Request->OnProcessRequestComplete().Unbind();
+	}
+	PendingRequests.Empty();
+}
+
+void FGoogleAnalyticsHttpTransport::Pump()
+{
+	// Completion delegates are fired from the HTTP manager tick, which only runs on the game thread
+	if (IsInGameThread())
+	{
+		FHttpModule::Get().GetHttpManager().Tick(0.0f);
+	}
+}
+
+void FGoogleAnalyticsHttpTransport::OnRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bSucceeded, FGoogleAnalyticsBatchComplete OnComplete)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		const int32 NumRemoved = PendingRequests.RemoveAllSwap([&Request](const TSharedRef<IHttpRequest>& PendingRequest)
+		{
+			return &PendingRequest.Get() == Request.Get();
+		});
+
+		// Not registered: the request failed to start and SendBatch reports that itself
+		if (NumRemoved == 0)
+		{
+			return;
+		}
+	}
+
+	OnComplete.ExecuteIfBound(bSucceeded && Response.IsValid() ? Response->GetResponseCode() : 0);
+}
+
+FGoogleAnalyticsFileTransport::FGoogleAnalyticsFileTransport(const FString& InFilename) :
+	Filename(InFilename),
+	Writer(nullptr)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+	Writer = PlatformFile.OpenWrite(*Filename, true);
+
+	if (Writer == nullptr)
+	{
+		UE_LOG(LogGoogleAnalytics, Warning, TEXT("Unable to open %s for writing analytics batches"), *Filename);
+	}
+}
+
+FGoogleAnalyticsFileTransport::~FGoogleAnalyticsFileTransport()
+{
+	delete Writer;
+}
+
+bool FGoogleAnalyticsFileTransport::SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (Writer == nullptr || !Writer->Write(Body.GetData(), Body.Num()))
+		{
+			return false;
+		}
+		Writer->Flush();
+	}
+
+	OnComplete.ExecuteIfBound(200);
+	return true;
+}
+
+bool FGoogleAnalyticsMemoryTransport::SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		FGoogleAnalyticsCapturedBatch& Batch = Batches[Batches.AddDefaulted()];
+		Batch.ContentEncoding = ContentEncoding != nullptr ? ContentEncoding : TEXT("");
+		Batch.Body = Body;
+	}
+
+	OnComplete.ExecuteIfBound(200);
+	return true;
+}
+
+TArray<FGoogleAnalyticsCapturedBatch> FGoogleAnalyticsMemoryTransport::TakeBatches()
+{
+	FScopeLock ScopeLock(&Lock);
+	return MoveTemp(Batches);
+}
+
+bool FGoogleAnalyticsNullTransport::SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete)
+{
+	OnComplete.ExecuteIfBound(200);
+	return true;
+}
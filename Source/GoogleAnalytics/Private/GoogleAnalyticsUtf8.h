@@ -0,0 +1,62 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** UTF-8 conversion shared by the hit validator and the hit builder, so byte limits are checked against the bytes actually sent */
+namespace GoogleAnalyticsUtf8
+{
+	/** Reads the code point at Index, combining UTF-16 surrogate pairs, a lone surrogate or invalid code point becomes the replacement character */
+	inline uint32 DecodeChar(const TCHAR* Chars, const int32 Length, int32& Index)
+	{
+		uint32 Code = (uint32)Chars[Index];
+
+		if (Code >= 0xD800 && Code <= 0xDBFF && Index + 1 < Length && (uint32)Chars[Index + 1] >= 0xDC00 && (uint32)Chars[Index + 1] <= 0xDFFF)
+		{
+			Code = 0x10000 + ((Code - 0xD800) << 10) + ((uint32)Chars[++Index] - 0xDC00);
+		}
+		else if ((Code >= 0xD800 && Code <= 0xDFFF) || Code > 0x10FFFF)
+		{
+			Code = 0xFFFD;
+		}
+
+		return Code;
+	}
+
+	/** Number of bytes EncodeChar writes for a code point returned by DecodeChar */
+	inline int32 GetEncodedLength(const uint32 Code)
+	{
+		return Code < 0x80 ? 1 : Code < 0x800 ? 2 : Code < 0x10000 ? 3 : 4;
+	}
+
+	/** Writes the code point as UTF-8, returns the number of bytes */
+	inline int32 EncodeChar(const uint32 Code, uint8* Bytes)
+	{
+		if (Code < 0x80)
+		{
+			Bytes[0] = (uint8)Code;
+			return 1;
+		}
+		if (Code < 0x800)
+		{
+			Bytes[0] = (uint8)(0xC0 | (Code >> 6));
+			Bytes[1] = (uint8)(0x80 | (Code & 0x3F));
+			return 2;
+		}
+		if (Code < 0x10000)
+		{
+			Bytes[0] = (uint8)(0xE0 | (Code >> 12));
+			Bytes[1] = (uint8)(0x80 | ((Code >> 6) & 0x3F));
+			Bytes[2] = (uint8)(0x80 | (Code & 0x3F));
+			return 3;
+		}
+		Bytes[0] = (uint8)(0xF0 | (Code >> 18));
+		Bytes[1] = (uint8)(0x80 | ((Code >> 12) & 0x3F));
+		Bytes[2] = (uint8)(0x80 | ((Code >> 6) & 0x3F));
+		Bytes[3] = (uint8)(0x80 | (Code & 0x3F));
+		return 4;
+	}
+}
@@ -0,0 +1,325 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "GoogleAnalyticsWorker.h"
+#include "GoogleAnalytics.h"
+#include "GoogleAnalyticsSettings.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+
+/** How often the worker wakes up to encode queued hits and tick the dispatcher */
+static const uint32 GoogleAnalyticsWorkerWaitMs = 100;
+
+FGoogleAnalyticsWorker::FFlushRequest::FFlushRequest() :
+	DispatchedEvent(FPlatformProcess::GetSynchEventFromPool(true))
+{
+}
+
+FGoogleAnalyticsWorker::FFlushRequest::~FFlushRequest()
+{
+	FPlatformProcess::ReturnSynchEventToPool(DispatchedEvent);
+}
+
+FGoogleAnalyticsWorker::FGoogleAnalyticsWorker(const int32 SendInterval) :
+	WakeEvent(FPlatformProcess::GetSynchEventFromPool(false)),
+	Thread(nullptr),
+	bStopping(false),
+	bAnonymizeIp(false),
+	bSessionStartSent(false),
+	Aggregator(GetDefault<UGoogleAnalyticsSettings>()->AggregatedEventCategories, GetDefault<UGoogleAnalyticsSettings>()->AggregationIntervalSeconds, GetDefault<UGoogleAnalyticsSettings>()->AggregationCountMetricIndex),
+	Coalescer(GetDefault<UGoogleAnalyticsSettings>()->CoalesceWindowSeconds, GetDefault<UGoogleAnalyticsSettings>()->CoalesceCountDimensionIndex),
+	Validator(GetDefault<UGoogleAnalyticsSettings>()->ValidationPolicy, GetDefault<UGoogleAnalyticsSettings>()->bReportValidationErrors),
+	Dispatcher(SendInterval)
+{
+	UpdateCommonPrefix();
+
+	if (FPlatformProcess::SupportsMultithreading())
+	{
+		Thread = FRunnableThread::Create(this, TEXT("GoogleAnalyticsWorker"), 0, TPri_BelowNormal);
+	}
+
+	if (Thread == nullptr)
+	{
+		// Without threads the same work is done from the game thread ticker
+		TickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FGoogleAnalyticsWorker::Tick));
+	}
+}
+
+FGoogleAnalyticsWorker::~FGoogleAnalyticsWorker()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+	else
+	{
+		FTicker::GetCoreTicker().RemoveTicker(TickHandle);
+	}
+
+	// Hits recorded after the last wake-up still have to reach the dispatcher, which from now on keeps persisted hits for the next run
+	Dispatcher.BeginShutdown();
+	ProcessCommands();
+	ReleaseHeldHits(true);
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+}
+
+void FGoogleAnalyticsWorker::StartSession(const FString& InTrackingId, const FString& InClientId, const bool bInAnonymizeIp)
+{
+	FCommand Command(ECommand::StartSession);
+	Command.Value = InTrackingId;
+	Command.SecondValue = InClientId;
+	Command.bValue = bInAnonymizeIp;
+	EnqueueCommand(MoveTemp(Command));
+}
+
+void FGoogleAnalyticsWorker::SetUserId(const FString& InUserId)
+{
+	FCommand Command(ECommand::SetUserId);
+	Command.Value = InUserId;
+	EnqueueCommand(MoveTemp(Command));
+}
+
+void FGoogleAnalyticsWorker::SetLocation(const FString& InLocation)
+{
+	FCommand Command(ECommand::SetLocation);
+	Command.Value = InLocation;
+	EnqueueCommand(MoveTemp(Command));
+}
+
+void FGoogleAnalyticsWorker::SetAnonymizeIp(const bool bInAnonymizeIp)
+{
+	FCommand Command(ECommand::SetAnonymizeIp);
+	Command.bValue = bInAnonymizeIp;
+	EnqueueCommand(MoveTemp(Command));
+}
+
+void FGoogleAnalyticsWorker::SetSystemInfo(const FString& InSystemInfo)
+{
+	FCommand Command(ECommand::SetSystemInfo);
+	Command.Value = InSystemInfo;
+	EnqueueCommand(MoveTemp(Command));
+}
+
+void FGoogleAnalyticsWorker::RecordHit(FGoogleAnalyticsHitRecord&& Hit)
+{
+	FCommand Command(ECommand::RecordHit);
+	Command.Hit = MoveTemp(Hit);
+	EnqueueCommand(MoveTemp(Command));
+}
+
+bool FGoogleAnalyticsWorker::Flush(const float TimeoutSeconds)
+{
+	const double Deadline = FPlatformTime::Seconds() + TimeoutSeconds;
+	TSharedPtr<FFlushRequest, ESPMode::ThreadSafe> FlushRequest = MakeShareable(new FFlushRequest());
+
+	FCommand Command(ECommand::Flush);
+	Command.FlushRequest = FlushRequest;
+	EnqueueCommand(MoveTemp(Command));
+
+	if (Thread == nullptr)
+	{
+		return FlushWithoutThread(Deadline);
+	}
+
+	WakeEvent->Trigger();
+
+	const uint32 WaitMs = (uint32)FMath::Max(0.0, (Deadline - FPlatformTime::Seconds()) * 1000.0);
+	if (!FlushRequest->DispatchedEvent->Wait(WaitMs))
+	{
+		return false;
+	}
+
+	return Dispatcher.WaitForInFlightBatches(Deadline);
+}
+
+bool FGoogleAnalyticsWorker::FlushWithoutThread(const double Deadline)
+{
+	// The ticker can't run while the game thread waits here, so the waiting thread keeps dispatching itself: hits over
+	// the in-flight limit, retries and anything recorded after the flush would otherwise never be sent
+	double LastTickTime = FPlatformTime::Seconds();
+
+	for (;;)
+	{
+		const double Now = FPlatformTime::Seconds();
+		Tick(Now - LastTickTime);
+		LastTickTime = Now;
+
+		// Short slices, so the queue is dispatched again as soon as a request slot frees up
+		if (Dispatcher.WaitForInFlightBatches(FMath::Min(Deadline, Now + GoogleAnalyticsWorkerWaitMs / 1000.0)))
+		{
+			return true;
+		}
+
+		if (FPlatformTime::Seconds() >= Deadline)
+		{
+			return false;
+		}
+	}
+}
+
+uint32 FGoogleAnalyticsWorker::Run()
+{
+	double LastTickTime = FPlatformTime::Seconds();
+
+	while (!bStopping)
+	{
+		WakeEvent->Wait(GoogleAnalyticsWorkerWaitMs);
+
+		const double Now = FPlatformTime::Seconds();
+		Tick(Now - LastTickTime);
+		LastTickTime = Now;
+	}
+
+	return 0;
+}
+
+void FGoogleAnalyticsWorker::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+void FGoogleAnalyticsWorker::EnqueueCommand(FCommand&& Command)
+{
+	// Producers never wake the worker for hits, it picks them up on its next tick
+	Commands.Enqueue(MoveTemp(Command));
+}
+
+void FGoogleAnalyticsWorker::ProcessCommands()
+{
+	FCommand Command;
+
+	while (Commands.Dequeue(Command))
+	{
+		// Held back hits belong to the tracking state they were recorded with
+		if (Command.Type != ECommand::RecordHit && Command.Type != ECommand::SetSystemInfo)
+		{
+			ReleaseHeldHits(true);
+		}
+
+		switch (Command.Type)
+		{
+		case ECommand::StartSession:
+			TrackingId = Command.Value;
+			ClientId = Command.SecondValue;
+			bAnonymizeIp = Command.bValue;
+			bSessionStartSent = false;
+			UpdateCommonPrefix();
+			Dispatcher.RestorePersistedHits();
+			break;
+		case ECommand::SetUserId:
+			UserId = Command.Value;
+			UpdateCommonPrefix();
+			break;
+		case ECommand::SetLocation:
+			Location = Command.Value;
+			UpdateCommonPrefix();
+			break;
+		case ECommand::SetAnonymizeIp:
+			bAnonymizeIp = Command.bValue;
+			break;
+		case ECommand::SetSystemInfo:
+			SystemInfo = Command.Value;
+			break;
+		case ECommand::RecordHit:
+			if (Aggregator.CanAggregate(Command.Hit))
+			{
+				Aggregator.Add(MoveTemp(Command.Hit));
+			}
+			else if (Coalescer.CanCoalesce(Command.Hit))
+			{
+				Coalescer.Add(MoveTemp(Command.Hit));
+			}
+			else
+			{
+				DispatchHit(Command.Hit);
+			}
+			break;
+		case ECommand::Flush:
+			Dispatcher.Flush();
+			Command.FlushRequest->DispatchedEvent->Trigger();
+			break;
+		}
+	}
+}
+
+bool FGoogleAnalyticsWorker::Tick(float DeltaTime)
+{
+	ProcessCommands();
+	ReleaseHeldHits(false);
+	Dispatcher.Tick(DeltaTime);
+	return true;
+}
+
+void FGoogleAnalyticsWorker::ReleaseHeldHits(const bool bReleaseAll)
+{
+	ReleasedHits.Reset();
+	Aggregator.Release(bReleaseAll, ReleasedHits);
+	Coalescer.Release(bReleaseAll, ReleasedHits);
+
+	for (FGoogleAnalyticsHitRecord& Hit : ReleasedHits)
+	{
+		DispatchHit(Hit);
+	}
+}
+
+void FGoogleAnalyticsWorker::DispatchHit(FGoogleAnalyticsHitRecord& Hit)
+{
+	if (!Validator.Validate(Hit))
+	{
+		return;
+	}
+
+	// Encoded straight to UTF-8, the payload is sent and persisted as is. The builder keeps its buffer, the queued copy goes
+	// into a buffer recycled from a delivered hit
+	EncodeHit(Hit);
+
+	TArray<uint8> Payload = Dispatcher.AcquirePayloadBuffer();
+	Payload.Append(HitBuilder.GetPayload());
+	Dispatcher.EnqueueHit(MoveTemp(Payload), Hit.CaptureTime, GetGoogleAnalyticsHitPriority(Hit.Type));
+}
+
+void FGoogleAnalyticsWorker::UpdateCommonPrefix()
+{
+	HitBuilder.Reset();
+	HitBuilder.AppendParam("v", 1);
+	HitBuilder.AppendParam("tid", TrackingId);
+	HitBuilder.AppendParam("cid", ClientId);
+	HitBuilder.AppendParam("geoid", Location);
+	HitBuilder.AppendParam("uid", UserId);
+	CommonPrefix = HitBuilder.GetPayload();
+}
+
+void FGoogleAnalyticsWorker::EncodeHit(const FGoogleAnalyticsHitRecord& Hit)
+{
+	HitBuilder.Reset();
+	HitBuilder.AppendEncodedBytes(CommonPrefix);
+	HitBuilder.AppendHitFields(Hit);
+
+	for (const FCustomDimension& CustomDimension : Hit.CustomDimensions)
+	{
+		HitBuilder.AppendIndexedParam("cd", CustomDimension.Index, CustomDimension.Value);
+	}
+
+	for (const FCustomMetric& CustomMetric : Hit.CustomMetrics)
+	{
+		HitBuilder.AppendIndexedParam("cm", CustomMetric.Index, (double)CustomMetric.Value);
+	}
+
+	HitBuilder.AppendFragment(SystemInfo);
+
+	if (!bSessionStartSent)
+	{
+		bSessionStartSent = true;
+		HitBuilder.AppendFragment("&sc=start");
+	}
+
+	if (bAnonymizeIp)
+	{
+		HitBuilder.AppendFragment("&aip=1");
+	}
+}
@@ -0,0 +1,151 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "GoogleAnalyticsHitRecord.h"
+#include "GoogleAnalyticsDispatcher.h"
+#include "GoogleAnalyticsHitCoalescer.h"
+#include "GoogleAnalyticsEventAggregator.h"
+#include "GoogleAnalyticsHitValidator.h"
+#include "GoogleAnalyticsHitBuilder.h"
+
+class FRunnableThread;
+
+/**
+ * Dedicated analytics thread (platforms without native SDK).
+ * Any thread may record hits or change the tracking state, which only costs an enqueue into a lock-free
+ * multi-producer queue. The worker owns the tracking state, encodes the hits and drives the dispatcher.
+ * Encoding and queueing on the worker don't allocate in steady state, recording still allocates a queue node per command
+ * and the text values of the hit.
+ */
+class FGoogleAnalyticsWorker : public FRunnable
+{
+public:
+	FGoogleAnalyticsWorker(const int32 SendInterval);
+	virtual ~FGoogleAnalyticsWorker();
+
+	void StartSession(const FString& TrackingId, const FString& ClientId, const bool bAnonymizeIp);
+	void SetUserId(const FString& UserId);
+	void SetLocation(const FString& Location);
+	void SetAnonymizeIp(const bool bAnonymizeIp);
+	void SetSystemInfo(const FString& SystemInfo);
+	void RecordHit(FGoogleAnalyticsHitRecord&& Hit);
+
+	/** Sends everything recorded so far, waiting up to TimeoutSeconds for delivery. Returns false if the wait timed out */
+	bool Flush(const float TimeoutSeconds);
+
+	/** Hits dropped so far because queued hits went over the memory budget */
+	int32 GetNumOverflowedHits() const
+	{
+		return Dispatcher.GetNumOverflowedHits();
+	}
+
+	/** Hits dropped over the rate limit, and hits held back until tokens were available */
+	int32 GetNumRateLimitDroppedHits() const
+	{
+		return Dispatcher.GetNumRateLimitDroppedHits();
+	}
+
+	int32 GetNumRateLimitDeferredHits() const
+	{
+		return Dispatcher.GetNumRateLimitDeferredHits();
+	}
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	enum class ECommand : uint8
+	{
+		StartSession,
+		SetUserId,
+		SetLocation,
+		SetAnonymizeIp,
+		SetSystemInfo,
+		RecordHit,
+		Flush
+	};
+
+	/** Signalled by the worker once everything queued before the flush has been handed to the dispatcher */
+	struct FFlushRequest
+	{
+		FEvent* DispatchedEvent;
+
+		FFlushRequest();
+		~FFlushRequest();
+	};
+
+	struct FCommand
+	{
+		ECommand Type;
+		FString Value;
+		FString SecondValue;
+		bool bValue;
+		FGoogleAnalyticsHitRecord Hit;
+		TSharedPtr<FFlushRequest, ESPMode::ThreadSafe> FlushRequest;
+
+		FCommand()
+			: Type(ECommand::RecordHit)
+			, bValue(false)
+		{
+		}
+
+		explicit FCommand(const ECommand InType)
+			: Type(InType)
+			, bValue(false)
+		{
+		}
+	};
+
+	void EnqueueCommand(FCommand&& Command);
+	void ProcessCommands();
+	bool Tick(float DeltaTime);
+
+	/** Flush for platforms without threads, where the calling game thread has to do the worker's work while it waits */
+	bool FlushWithoutThread(const double Deadline);
+
+	/** Hands held back hits to the dispatcher: due summaries and coalesced hits, or all of them */
+	void ReleaseHeldHits(const bool bReleaseAll);
+
+	/** Validates and encodes the hit with the current tracking state, then queues it for dispatch */
+	void DispatchHit(FGoogleAnalyticsHitRecord& Hit);
+
+	/** Re-encodes the parameters shared by every hit, after the tracking identity changed */
+	void UpdateCommonPrefix();
+
+	/** Encodes the hit into HitBuilder */
+	void EncodeHit(const FGoogleAnalyticsHitRecord& Hit);
+
+	TQueue<FCommand, EQueueMode::Mpsc> Commands;
+	FEvent* WakeEvent;
+	FRunnableThread* Thread;
+	FThreadSafeBool bStopping;
+	FDelegateHandle TickHandle;
+
+	// Tracking state, owned by the worker
+	FString TrackingId;
+	FString ClientId;
+	FString UserId;
+	FString Location;
+	FString SystemInfo;
+
+	/** Encoded v, tid, cid, geoid and uid parameters starting every hit */
+	TArray<uint8> CommonPrefix;
+	bool bAnonymizeIp;
+	bool bSessionStartSent;
+
+	FGoogleAnalyticsEventAggregator Aggregator;
+	FGoogleAnalyticsHitCoalescer Coalescer;
+	FGoogleAnalyticsHitValidator Validator;
+	FGoogleAnalyticsHitBuilder HitBuilder;
+	TArray<FGoogleAnalyticsHitRecord> ReleasedHits;
+	FGoogleAnalyticsDispatcher Dispatcher;
+};
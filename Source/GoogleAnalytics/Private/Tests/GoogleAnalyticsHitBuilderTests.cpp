@@ -0,0 +1,332 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/MemoryBase.h"
+#include "PlatformHttp.h"
+#include "GoogleAnalyticsHitBuilder.h"
+#include "GoogleAnalyticsHitRecord.h"
+#include "GoogleAnalyticsHitValidator.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GoogleAnalyticsHitBuilderTests
+{
+	/** Plain ASCII, reserved characters, Latin-2 text, CJK and a character outside the BMP */
+	const TCHAR* const SampleValues[] = {
+		TEXT("Default Category"),
+		TEXT("LevelComplete_Stage12"),
+		TEXT("a&b=c d+e/f?g#h%i"),
+		TEXT("Za\u017C\u00F3\u0142\u0107 g\u0119\u015Bl\u0105 ja\u017A\u0144"),
+		TEXT("\u30B2\u30FC\u30E0\u958B\u59CB"),
+		TEXT("Score \U0001F600 shared")
+	};
+
+	/** Encoded value of a single parameter, without the parameter name */
+	FString EncodeWithBuilder(FGoogleAnalyticsHitBuilder& Builder, const FString& Value)
+	{
+		Builder.Reset();
+		Builder.AppendParam("v", Value);
+
+		const TArray<uint8>& Payload = Builder.GetPayload();
+		FString Result;
+		for (int32 Index = 2; Index < Payload.Num(); Index++)
+		{
+			Result.AppendChar((TCHAR)Payload[Index]);
+		}
+		return Result;
+	}
+
+	/**
+	 * Forwards to the engine allocator, counting the allocations made by the installing thread while installed as GMalloc.
+	 * Other threads may still be inside a call after it is uninstalled, so the instance is never destroyed.
+	 */
+	class FCountingMalloc : public FMalloc
+	{
+	public:
+		FCountingMalloc()
+			: Inner(nullptr)
+			, ThreadId(0)
+			, NumAllocations(0)
+		{
+		}
+
+		void Install()
+		{
+			check(GMalloc != this);
+			Inner = GMalloc;
+			ThreadId = FPlatformTLS::GetCurrentThreadId();
+			NumAllocations = 0;
+			GMalloc = this;
+		}
+
+		void Uninstall()
+		{
+			check(GMalloc == this);
+			GMalloc = Inner;
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return TEXT("GoogleAnalyticsCountingMalloc");
+		}
+
+		int32 GetNumAllocations() const
+		{
+			return NumAllocations;
+		}
+
+	private:
+		void CountAllocation()
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				NumAllocations++;
+			}
+		}
+
+		FMalloc* Inner;
+		uint32 ThreadId;
+		int32 NumAllocations;
+	};
+
+	FCountingMalloc& GetCountingMalloc()
+	{
+		static FCountingMalloc* CountingMalloc = new FCountingMalloc();
+		return *CountingMalloc;
+	}
+
+	/** Encodes a hit the way the analytics worker does */
+	void EncodeHit(FGoogleAnalyticsHitBuilder& Builder, const TArray<uint8>& CommonPrefix, const FGoogleAnalyticsHitRecord& Hit, const FString& SystemInfo)
+	{
+		Builder.Reset();
+		Builder.AppendEncodedBytes(CommonPrefix);
+		Builder.AppendHitFields(Hit);
+
+		for (const FCustomDimension& CustomDimension : Hit.CustomDimensions)
+		{
+			Builder.AppendIndexedParam("cd", CustomDimension.Index, CustomDimension.Value);
+		}
+
+		for (const FCustomMetric& CustomMetric : Hit.CustomMetrics)
+		{
+			Builder.AppendIndexedParam("cm", CustomMetric.Index, (double)CustomMetric.Value);
+		}
+
+		Builder.AppendFragment(SystemInfo);
+		Builder.AppendFragment("&aip=1");
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGoogleAnalyticsUrlEncodeTest, "Plugins.GoogleAnalytics.HitBuilder.UrlEncode", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGoogleAnalyticsUrlEncodeTest::RunTest(const FString& Parameters)
+{
+	using namespace GoogleAnalyticsHitBuilderTests;
+
+	FGoogleAnalyticsHitBuilder Builder;
+
+	for (const TCHAR* Value : SampleValues)
+	{
+		TestEqual(FString::Printf(TEXT("Encoding of \"%s\""), Value), EncodeWithBuilder(Builder, Value), FPlatformHttp::UrlEncode(Value));
+	}
+
+	// Long values cross the word at a time path with the remainder handled per character
+	const FString LongValue = FString::ChrN(1000, TEXT('x')) + TEXT("\u00E9 &") + FString::ChrN(3, TEXT('y'));
+	TestEqual(TEXT("Encoding of a long value"), EncodeWithBuilder(Builder, LongValue), FPlatformHttp::UrlEncode(LongValue));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGoogleAnalyticsUtf8LengthTest, "Plugins.GoogleAnalytics.HitBuilder.Utf8Length", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGoogleAnalyticsUtf8LengthTest::RunTest(const FString& Parameters)
+{
+	using namespace GoogleAnalyticsHitBuilderTests;
+
+	TArray<FString> Values;
+	for (const TCHAR* Value : SampleValues)
+	{
+		Values.Add(Value);
+	}
+
+	// Unpaired surrogates are sent as U+FFFD, built char by char as they can't be written as literals with 4 byte TCHAR
+	FString LoneHighSurrogate(TEXT("a"));
+	LoneHighSurrogate.AppendChar((TCHAR)0xD800);
+	LoneHighSurrogate.AppendChar(TEXT('b'));
+	Values.Add(LoneHighSurrogate);
+
+	FString LoneLowSurrogate;
+	LoneLowSurrogate.AppendChar((TCHAR)0xDC00);
+	LoneLowSurrogate.AppendChar(TEXT('c'));
+	LoneLowSurrogate.AppendChar((TCHAR)0xD800);
+	Values.Add(LoneLowSurrogate);
+
+	FGoogleAnalyticsHitBuilder Builder;
+
+	for (int32 ValueIndex = 0; ValueIndex < Values.Num(); ValueIndex++)
+	{
+		const FString& Value = Values[ValueIndex];
+
+		Builder.Reset();
+		Builder.AppendFragment(Value);
+		const int32 SentBytes = Builder.GetPayload().Num();
+
+		TestEqual(FString::Printf(TEXT("UTF-8 length of value %d"), ValueIndex), FGoogleAnalyticsHitValidator::GetUtf8Length(Value), SentBytes);
+
+		// Every prefix the validator picks has to fit once encoded, and the whole value fits in its own length
+		for (int32 MaxBytes = 0; MaxBytes < SentBytes; MaxBytes++)
+		{
+			const int32 NumChars = FGoogleAnalyticsHitValidator::GetUtf8PrefixLength(Value, MaxBytes);
+			TestTrue(FString::Printf(TEXT("Prefix of value %d fits in %d bytes"), ValueIndex, MaxBytes), FGoogleAnalyticsHitValidator::GetUtf8Length(Value.Left(NumChars)) <= MaxBytes);
+		}
+		TestEqual(FString::Printf(TEXT("Prefix of value %d in its own length"), ValueIndex), FGoogleAnalyticsHitValidator::GetUtf8PrefixLength(Value, SentBytes), Value.Len());
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGoogleAnalyticsHitBuilderAllocationTest, "Plugins.GoogleAnalytics.HitBuilder.EncodingAllocations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGoogleAnalyticsHitBuilderAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace GoogleAnalyticsHitBuilderTests;
+
+	FGoogleAnalyticsHitBuilder Builder;
+
+	Builder.AppendParam("v", 1);
+	Builder.AppendParam("tid", FString(TEXT("UA-12345678-1")));
+	Builder.AppendParam("cid", FString(TEXT("35009a79-1a05-49d7-b876-2b884d0f825b")));
+	const TArray<uint8> CommonPrefix = Builder.GetPayload();
+	const FString SystemInfo(TEXT("&ul=en-US&ua=Windows&sr=1920x1080&vp=1920x1080"));
+
+	TArray<FGoogleAnalyticsHitRecord> Hits;
+	for (int32 Index = 0; Index < (int32)ARRAY_COUNT(SampleValues); Index++)
+	{
+		Hits.AddDefaulted();
+		FGoogleAnalyticsHitRecord& Hit = Hits.Last();
+		Hit.Type = (EGoogleAnalyticsHitType)(Index % NumGoogleAnalyticsHitTypes);
+		for (FString& Text : Hit.Text)
+		{
+			Text = SampleValues[Index];
+		}
+		Hit.Number[0] = 12.5;
+		Hit.Number[1] = 3.0;
+
+		FCustomDimension CustomDimension;
+		CustomDimension.Index = 1;
+		CustomDimension.Value = SampleValues[Index];
+		Hit.CustomDimensions.Add(CustomDimension);
+
+		FCustomMetric CustomMetric;
+		CustomMetric.Index = 2;
+		CustomMetric.Value = 4.25f;
+		Hit.CustomMetrics.Add(CustomMetric);
+	}
+
+	// The buffer is sized up front, so encoding must not allocate from the first hit on. Only encoding is covered: recording a hit
+	// still allocates a command queue node and copies the hit's text values on the recording thread
+	FCountingMalloc& CountingMalloc = GetCountingMalloc();
+	CountingMalloc.Install();
+
+	for (int32 Iteration = 0; Iteration < 100; Iteration++)
+	{
+		for (const FGoogleAnalyticsHitRecord& Hit : Hits)
+		{
+			EncodeHit(Builder, CommonPrefix, Hit, SystemInfo);
+		}
+	}
+
+	CountingMalloc.Uninstall();
+
+	TestEqual(TEXT("Allocations while encoding hits"), CountingMalloc.GetNumAllocations(), 0);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGoogleAnalyticsUrlEncodeBenchmark, "Plugins.GoogleAnalytics.HitBuilder.UrlEncodeBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGoogleAnalyticsUrlEncodeBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace GoogleAnalyticsHitBuilderTests;
+
+	const int32 NumIterations = 20000;
+
+	TArray<FString> Values;
+	for (const TCHAR* Value : SampleValues)
+	{
+		Values.Add(Value);
+	}
+
+	FGoogleAnalyticsHitBuilder Builder;
+	int32 NumBytes = 0;
+
+	const double BuilderStart = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+	{
+		Builder.Reset();
+		for (const FString& Value : Values)
+		{
+			Builder.AppendParam("v", Value);
+		}
+		NumBytes += Builder.GetPayload().Num();
+	}
+	const double BuilderSeconds = FPlatformTime::Seconds() - BuilderStart;
+
+	// What the hits were encoded with before: UrlEncode per value, then the whole hit converted to UTF-8
+	const double UrlEncodeStart = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+	{
+		FString Hit;
+		for (const FString& Value : Values)
+		{
+			Hit += TEXT("&v=") + FPlatformHttp::UrlEncode(Value);
+		}
+		FTCHARToUTF8 Converter(*Hit);
+		NumBytes += Converter.Length();
+	}
+	const double UrlEncodeSeconds = FPlatformTime::Seconds() - UrlEncodeStart;
+
+	AddInfo(FString::Printf(TEXT("%d iterations of %d values (%d bytes): hit builder %.2f ms, FPlatformHttp::UrlEncode %.2f ms, %.1fx"),
+		NumIterations, Values.Num(), NumBytes, BuilderSeconds * 1000.0, UrlEncodeSeconds * 1000.0, BuilderSeconds > 0.0 ? UrlEncodeSeconds / BuilderSeconds : 0.0));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -11,11 +11,13 @@
 DECLARE_LOG_CATEGORY_EXTERN(LogGoogleAnalytics, Log, All);
 
 class IAnalyticsProvider;
+class IGoogleAnalyticsTransport;
 
 class FAnalyticsGoogleAnalytics :
 	public IAnalyticsProviderModule
 {
 	TSharedPtr<IAnalyticsProvider> Provider;
+	TSharedPtr<IGoogleAnalyticsTransport, ESPMode::ThreadSafe> TransportOverride;
 
 public:
 	static inline FAnalyticsGoogleAnalytics& Get()
@@ -26,6 +28,12 @@ public:
 public:
 	virtual TSharedPtr<IAnalyticsProvider> CreateAnalyticsProvider(const FAnalyticsProviderConfigurationDelegate& GetConfigValue) const override;
 
+	/** Replaces the transport configured in settings for providers created afterwards (platforms without native SDK), null restores it */
+	void SetTransport(const TSharedPtr<IGoogleAnalyticsTransport, ESPMode::ThreadSafe>& InTransport);
+
+	/** Returns the transport override, or creates the transport configured in settings */
+	TSharedRef<IGoogleAnalyticsTransport, ESPMode::ThreadSafe> CreateTransport() const;
+
 private:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
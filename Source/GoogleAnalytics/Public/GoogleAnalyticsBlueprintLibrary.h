@@ -52,4 +52,8 @@ class GOOGLEANALYTICS_API UGoogleAnalyticsBlueprintLibrary : public UBlueprintFu
 	/** If true, the IP address of the sender will be anonymized - GDPR compliant (only for Google Analytics) */
 	UFUNCTION(BlueprintCallable, Category = "Analytics")
 	static void SetAnonymizeIP(const bool Anonymize);
+
+	/** Sends all pending hits, waiting up to MaxWaitSeconds for them to be delivered. Returns false if the wait timed out (only for Google Analytics) */
+	UFUNCTION(BlueprintCallable, Category = "Analytics")
+	static bool FlushGoogleEvents(const float MaxWaitSeconds);
 };
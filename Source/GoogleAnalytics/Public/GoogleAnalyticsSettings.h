@@ -8,6 +8,56 @@
 #include "Engine.h"
 #include "GoogleAnalyticsSettings.generated.h"
 
+UENUM()
+enum class EGoogleAnalyticsTransport : uint8
+{
+	/** POST to the collector URL */
+	Http,
+	/** Append batches to a local file */
+	File,
+	/** Keep batches in memory */
+	Memory,
+	/** Discard batches */
+	Null
+};
+
+UENUM()
+enum class EGoogleAnalyticsRateLimitPolicy : uint8
+{
+	/** Keep hits over the rate limit queued until tokens are available */
+	Queue,
+	/** Drop hits over the rate limit */
+	Drop
+};
+
+UENUM()
+enum class EGoogleAnalyticsQueueOverflowPolicy : uint8
+{
+	/** Drop the normal priority hits recorded first, high priority hits only once no normal priority hit is left */
+	DropOldest,
+	/** Drop the normal priority hits recorded last, high priority hits only once no normal priority hit is left */
+	DropNewest,
+	/** Drop normal priority hits, oldest first, before any high priority hit (same order as DropOldest) */
+	DropLowestPriority
+};
+
+UENUM()
+enum class EGoogleAnalyticsValidationPolicy : uint8
+{
+	/** Shorten fields over their Measurement Protocol limit */
+	Truncate,
+	/** Drop hits with fields over their Measurement Protocol limit */
+	Reject
+};
+
+UENUM()
+enum class EGoogleAnalyticsCompression : uint8
+{
+	None,
+	Deflate,
+	Gzip
+};
+
 UCLASS(config = Engine, defaultconfig)
 class GOOGLEANALYTICS_API UGoogleAnalyticsSettings : public UObject
 {
@@ -19,4 +69,92 @@ public:
 	/** Enable IDFA Collection - allows to track personal user informations */
 	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics", DisplayName = "Enable IDFA Collection")
 	bool bEnableIDFACollection;
+
+	/** Maximum number of analytics requests in flight at once on desktop, further hits wait in the queue */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop", meta = (ClampMin = "1"))
+	int32 MaxConcurrentRequests;
+
+	/** Memory budget in bytes for hits waiting to be sent on desktop, 0 removes the limit */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop", meta = (ClampMin = "0"))
+	int32 MaxQueuedHitBytes;
+
+	/** Which hits are dropped once queued hits exceed the memory budget */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop")
+	EGoogleAnalyticsQueueOverflowPolicy QueueOverflowPolicy;
+
+	/** What happens on desktop to hits with fields longer than the Measurement Protocol allows */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Validation")
+	EGoogleAnalyticsValidationPolicy ValidationPolicy;
+
+	/** Log every field over its limit as a warning, for catching oversized fields during development */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Validation")
+	bool bReportValidationErrors;
+
+	/** Where batched hits are sent on desktop */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop")
+	EGoogleAnalyticsTransport Transport;
+
+	/** Measurement Protocol /batch endpoint used by the Http transport, change it to send through a relay */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop")
+	FString CollectorUrl;
+
+	/** File written by the File transport, relative paths are resolved against the project Saved directory */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop")
+	FString TransportFilename;
+
+	/** Hits a client may send at once on desktop before the refill rate applies, 0 disables rate limiting */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Rate Limit", meta = (ClampMin = "0"))
+	int32 RateLimitBurst;
+
+	/** Hits per second added back to the burst allowance */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Rate Limit", meta = (ClampMin = "0.01"))
+	float RateLimitHitsPerSecond;
+
+	/** What happens to hits over the rate limit */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Rate Limit")
+	EGoogleAnalyticsRateLimitPolicy RateLimitPolicy;
+
+	/** Event categories counted on desktop instead of sent one by one, summarized per category, action and label */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Aggregation")
+	TArray<FString> AggregatedEventCategories;
+
+	/** How often summaries of aggregated events are sent, they are also sent on flush and at the end of the session */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Aggregation", meta = (ClampMin = "1"))
+	float AggregationIntervalSeconds;
+
+	/** Custom metric receiving the number of aggregated events, 0 only sends the summed value */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Aggregation", meta = (ClampMin = "0", ClampMax = "200"))
+	int32 AggregationCountMetricIndex;
+
+	/** Identical events and screen views recorded within this many seconds are merged into one hit on desktop, 0 disables merging */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Coalescing", meta = (ClampMin = "0"))
+	float CoalesceWindowSeconds;
+
+	/** Custom dimension receiving the number of merged hits, 0 only sums event values */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Coalescing", meta = (ClampMin = "0", ClampMax = "200"))
+	int32 CoalesceCountDimensionIndex;
+
+	/** Percentage of clients sending event hits on desktop, decided per client so a client is consistently in or out */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Sampling", meta = (ClampMin = "0", ClampMax = "100"))
+	float EventSampleRate;
+
+	/** Percentage of clients sending screen view hits on desktop */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Sampling", meta = (ClampMin = "0", ClampMax = "100"))
+	float PageviewSampleRate;
+
+	/** Percentage of clients sending social interaction hits on desktop */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Sampling", meta = (ClampMin = "0", ClampMax = "100"))
+	float SocialSampleRate;
+
+	/** Percentage of clients sending user timing hits on desktop */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop|Sampling", meta = (ClampMin = "0", ClampMax = "100"))
+	float TimingSampleRate;
+
+	/** Compression applied to batched hits on desktop, sent with the matching Content-Encoding header */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop")
+	EGoogleAnalyticsCompression BatchCompression;
+
+	/** Batches smaller than this many bytes are sent uncompressed */
+	UPROPERTY(Config, EditAnywhere, Category = "Google Analytics|Desktop", meta = (ClampMin = "0"))
+	int32 CompressionThresholdBytes;
 };
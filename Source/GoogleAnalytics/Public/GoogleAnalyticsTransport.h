@@ -0,0 +1,99 @@
+// Google Analytics Provider
+// Created by Patryk Stepniewski
+// Copyright (c) 2014-2018 gameDNA Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+#include "HAL/CriticalSection.h"
+
+class IFileHandle;
+
+/** Called once per batch with the HTTP status code of the response, or 0 if the collector could not be reached */
+DECLARE_DELEGATE_OneParam(FGoogleAnalyticsBatchComplete, int32 /*ResponseCode*/);
+
+/**
+ * Destination of batched Measurement Protocol hits (platforms without native SDK).
+ * Batches are handed over by the analytics worker, completions may be called on any thread.
+ */
+class GOOGLEANALYTICS_API IGoogleAnalyticsTransport
+{
+public:
+	virtual ~IGoogleAnalyticsTransport() {}
+
+	/** Starts sending a batch body (one hit per line), ContentEncoding is null for uncompressed bodies. If false is returned OnComplete is never called */
+	virtual bool SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete) = 0;
+
+	/** Drops completions of batches still being sent, called before the dispatcher goes away */
+	virtual void CancelPendingBatches() {}
+
+	/** Lets outstanding batches complete while a thread is blocked waiting for delivery */
+	virtual void Pump() {}
+};
+
+/** POSTs batches to a Measurement Protocol /batch endpoint, Google's collector or a relay */
+class GOOGLEANALYTICS_API FGoogleAnalyticsHttpTransport : public IGoogleAnalyticsTransport
+{
+public:
+	FGoogleAnalyticsHttpTransport(const FString& InUrl);
+	virtual ~FGoogleAnalyticsHttpTransport();
+
+	// IGoogleAnalyticsTransport interface
+	virtual bool SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete) override;
+	virtual void CancelPendingBatches() override;
+	virtual void Pump() override;
+
+private:
+	void OnRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bSucceeded, FGoogleAnalyticsBatchComplete OnComplete);
+
+	FString Url;
+	FCriticalSection Lock;
+	TArray<TSharedRef<IHttpRequest>> PendingRequests;
+};
+
+/** Appends batch bodies to a local file, useful for inspecting traffic or replaying it against a stand-in collector */
+class GOOGLEANALYTICS_API FGoogleAnalyticsFileTransport : public IGoogleAnalyticsTransport
+{
+public:
+	FGoogleAnalyticsFileTransport(const FString& InFilename);
+	virtual ~FGoogleAnalyticsFileTransport();
+
+	// IGoogleAnalyticsTransport interface
+	virtual bool SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete) override;
+
+private:
+	FString Filename;
+	FCriticalSection Lock;
+	IFileHandle* Writer;
+};
+
+/** Batch captured by FGoogleAnalyticsMemoryTransport */
+struct FGoogleAnalyticsCapturedBatch
+{
+	FString ContentEncoding;
+	TArray<uint8> Body;
+};
+
+/** Keeps batches in memory, for tests and for measuring encoding and queueing without a network */
+class GOOGLEANALYTICS_API FGoogleAnalyticsMemoryTransport : public IGoogleAnalyticsTransport
+{
+public:
+	// IGoogleAnalyticsTransport interface
+	virtual bool SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete) override;
+
+	/** Returns the batches captured so far and forgets them */
+	TArray<FGoogleAnalyticsCapturedBatch> TakeBatches();
+
+private:
+	FCriticalSection Lock;
+	TArray<FGoogleAnalyticsCapturedBatch> Batches;
+};
+
+/** Accepts and discards every batch */
+class GOOGLEANALYTICS_API FGoogleAnalyticsNullTransport : public IGoogleAnalyticsTransport
+{
+public:
+	// IGoogleAnalyticsTransport interface
+	virtual bool SendBatch(const TArray<uint8>& Body, const TCHAR* ContentEncoding, const FGoogleAnalyticsBatchComplete& OnComplete) override;
+};